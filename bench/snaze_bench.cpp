@@ -0,0 +1,312 @@
+/// Micro benchmarks of the snaze hot paths, over the shipped levels and synthetic large mazes.
+/// Every benchmark reports ns/op, heap allocations/op and ops/s, as CSV (default) or JSON lines,
+/// so runs of different builds can be diffed.
+#include "distance_field.hpp"
+#include "game_manager.hpp"
+#include "game_snapshot.hpp"
+#include "level_format.hpp"
+#include "maze.hpp"
+#include "rng.hpp"
+#include "simulation.hpp"
+#include "snake.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <new>
+#include <optional>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+std::atomic<size_t> g_allocations{0}; //!< Heap allocations made so far by the whole program
+} // namespace
+
+void *operator new(size_t size) {
+    ++g_allocations;
+    if (void *ptr = std::malloc(size == 0 ? 1 : size)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept { std::free(ptr); }
+void operator delete(void *ptr, size_t /*size*/) noexcept { std::free(ptr); }
+
+namespace {
+/// Cells the `astar_bounded` search may expand
+constexpr size_t BOUNDED_EXPANSIONS = 1024;
+
+/// Options read from the command line
+struct BenchOptions {
+    std::string levels_dir{"assets/"};
+    std::string filter;
+    double min_time_ms{200};
+    bool json{false};
+};
+
+/// Result of a single benchmark
+struct BenchResult {
+    std::string name;
+    std::string level;
+    size_t iterations{0};
+    double ns_per_op{0};
+    double allocs_per_op{0};
+    double ops_per_sec{0};
+    double nodes_per_op{0}; //!< Cells expanded per op, only for the searches
+    size_t bytes{0};        //!< Memory kept by what was built, for distance fields and snapshots
+};
+
+volatile size_t g_sink = 0; //!< Keeps the compiler from dropping benchmarked results
+
+/// Runs `op` with doubling iteration counts until a run takes at least `min_time_ms`
+BenchResult measure(const std::string &name, const std::string &level, double min_time_ms,
+                    const std::function<void()> &op) {
+    op(); // Warm up, so reusable buffers are already sized
+    size_t iterations = 1;
+    while (true) {
+        auto allocations_before = g_allocations.load();
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < iterations; ++i) {
+            op();
+        }
+        std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+        auto allocations = g_allocations.load() - allocations_before;
+        if (elapsed.count() >= min_time_ms * 1e6 or iterations >= (size_t{1} << 30)) {
+            BenchResult result;
+            result.name = name;
+            result.level = level;
+            result.iterations = iterations;
+            result.ns_per_op = elapsed.count() / (double)iterations;
+            result.allocs_per_op = (double)allocations / (double)iterations;
+            result.ops_per_sec = 1e9 / result.ns_per_op;
+            return result;
+        }
+        iterations *= 2;
+    }
+}
+
+/// Writes a square open maze of side `side`, with walls in the border and random walls in
+/// about a fifth of the inside, the spawn being at (1, 1). Returns the file path.
+std::string write_synthetic_maze(size_t side) {
+    std::mt19937 engine(static_cast<uint32_t>(side));
+    std::bernoulli_distribution wall(0.2);
+    auto path = std::filesystem::temp_directory_path() /
+                ("snaze_bench_" + std::to_string(side) + ".dat");
+    std::ofstream ofs(path);
+    ofs << side << ' ' << side << '\n';
+    for (size_t row = 0; row < side; ++row) {
+        for (size_t col = 0; col < side; ++col) {
+            bool border = row == 0 or col == 0 or row == side - 1 or col == side - 1;
+            if (row == 1 and col == 1) {
+                ofs << '&';
+            } else if (border or (row > 2 and col > 2 and wall(engine))) {
+                ofs << '#';
+            } else {
+                ofs << ' ';
+            }
+        }
+        ofs << '\n';
+    }
+    return path.string();
+}
+
+/// Builds a snake over the first `length` non wall cells of the maze, in row-major order
+snaze::Snake long_snake(const snaze::Maze &maze, size_t length) {
+    snaze::Snake snake;
+    snake.reset(maze);
+    for (size_t row = 0; row < maze.height() and snake.body().size() < length; ++row) {
+        for (size_t col = 0; col < maze.width() and snake.body().size() < length; ++col) {
+            snaze::Position pos(col, row);
+            if (not maze.is_wall(pos)) {
+                snake.push_back(pos);
+            }
+        }
+    }
+    return snake;
+}
+
+/// Runs every benchmark over the level in `level_file`
+void bench_level(const std::string &level_file, const BenchOptions &options,
+                 std::vector<BenchResult> &results) {
+    auto level = std::filesystem::path(level_file).filename().string();
+    results.push_back(measure("maze_load", level, options.min_time_ms, [&level_file] {
+        snaze::Maze maze(level_file, 0);
+        g_sink = g_sink + maze.width();
+    }));
+    auto compiled_file = (std::filesystem::temp_directory_path() /
+                          std::filesystem::path(level_file).stem().concat(
+                              snaze::COMPILED_LEVEL_EXTENSION))
+                             .string();
+    snaze::compile_level(level_file, compiled_file);
+    results.push_back(measure("compiled_load", level, options.min_time_ms, [&compiled_file] {
+        snaze::Maze maze(compiled_file, 0);
+        g_sink = g_sink + maze.width();
+    }));
+
+    snaze::Maze maze(level_file);
+    results.push_back(measure("distance_field", level, options.min_time_ms, [&maze] {
+        snaze::DistanceField distances(maze, snaze::Maze::DEFAULT_DISTANCE_BUDGET);
+        g_sink = g_sink + distances.landmarks();
+    }));
+    results.back().bytes = (maze.distances() != nullptr) ? maze.distances()->memory_bytes() : 0;
+
+    snaze::Snake snake;
+    snake.reset(maze);
+    snake.push_front(maze.start());
+    Rng rng(1);
+    maze.random_food_position(snake.open_cells(), rng);
+    for (auto mode : {snaze::BotMode::Smart, snaze::BotMode::Dumb}) {
+        snaze::SnakeBot bot(mode);
+        auto name = (mode == snaze::BotMode::Smart) ? "astar_solve" : "bfs_solve";
+        results.push_back(measure(name, level, options.min_time_ms, [&] {
+            g_sink = g_sink + (bot.solve(maze, snake) ? bot.solution->size() : 0);
+        }));
+        // Every run searches the same maze, so the last one tells the nodes of all of them
+        results.back().nodes_per_op = (double)bot.nodes_expanded();
+    }
+    // An anytime search cut at a fixed amount of cells, it costs the same whatever the maze size
+    snaze::SnakeBot bounded_bot;
+    const snaze::SearchLimit bounded{BOUNDED_EXPANSIONS, std::nullopt};
+    results.push_back(measure("astar_bounded", level, options.min_time_ms, [&] {
+        auto found = bounded_bot.solve(maze, snake, bounded);
+        g_sink = g_sink + (found ? bounded_bot.solution->size() : 0);
+    }));
+    results.back().nodes_per_op = (double)bounded_bot.nodes_expanded();
+
+    auto cells = maze.width() * maze.height();
+    auto body = long_snake(maze, std::max<size_t>(1, cells / 2));
+    results.push_back(measure("is_snake_body", level, options.min_time_ms, [&] {
+        size_t hits = 0;
+        for (size_t row = 0; row < maze.height(); ++row) {
+            for (size_t col = 0; col < maze.width(); ++col) {
+                hits += body.is_snake_body(snaze::Position(col, row)) ? 1 : 0;
+            }
+        }
+        g_sink = g_sink + hits;
+    }));
+    // The scan above does one lookup per cell, report it per lookup
+    results.back().ns_per_op /= (double)cells;
+    results.back().allocs_per_op /= (double)cells;
+    results.back().ops_per_sec *= (double)cells;
+
+    // The body covers half the maze, so most cells are only reachable once the tail left them
+    snaze::SnakeBot long_bot;
+    results.push_back(measure("long_snake_solve", level, options.min_time_ms, [&] {
+        g_sink = g_sink + (long_bot.solve(maze, body) ? long_bot.solution->size() : 0);
+    }));
+    results.back().nodes_per_op = (double)long_bot.nodes_expanded();
+
+    // With half the maze under the body, the food takes a couple of draws
+    auto food_maze = maze;
+    results.push_back(measure("food_placement", level, options.min_time_ms, [&] {
+        food_maze.random_food_position(body.open_cells(), rng);
+        g_sink = g_sink + food_maze.food().coord_x;
+    }));
+
+    results.push_back(measure("str_in_game", level, options.min_time_ms, [&] {
+        auto frame = maze.str_in_game(body.body(), snaze::Direction::Right);
+        g_sink = g_sink + frame.size();
+    }));
+
+    // Copies share the level, so they cost the same in every maze
+    results.push_back(measure("maze_copy", level, options.min_time_ms, [&] {
+        auto copy = maze;
+        g_sink = g_sink + copy.food().coord_x;
+    }));
+
+    // A game some ticks in, taken and put back as a rollback or a search over games would
+    snaze::Settings settings{};
+    settings.lives = 5;
+    settings.food_amount = 8;
+    snaze::Simulation game(level_file, maze, settings, snaze::BotMode::Smart, 1000, 1);
+    for (size_t tick = 0; tick < 64 and game.step(); ++tick) {
+    }
+    auto snapshot = game.snapshot();
+    results.push_back(measure("snapshot", level, options.min_time_ms, [&] {
+        auto taken = game.snapshot();
+        g_sink = g_sink + taken.body.size();
+    }));
+    results.push_back(measure("restore", level, options.min_time_ms, [&] {
+        game.restore(snapshot);
+        g_sink = g_sink + snapshot.ticks;
+    }));
+    std::ostringstream written;
+    results.push_back(measure("snapshot_write", level, options.min_time_ms, [&] {
+        written.str("");
+        snapshot.write(written, maze);
+        g_sink = g_sink + written.str().size();
+    }));
+    results.back().bytes = written.str().size();
+}
+
+void write_results(const std::vector<BenchResult> &results, bool json) {
+    if (not json) {
+        std::cout << "benchmark,level,iterations,ns_per_op,allocs_per_op,ops_per_sec,"
+                     "nodes_per_op,bytes\n";
+    }
+    for (const auto &result : results) {
+        if (json) {
+            std::cout << R"({"benchmark":")" << result.name << R"(","level":")" << result.level
+                      << R"(","iterations":)" << result.iterations
+                      << R"(,"ns_per_op":)" << result.ns_per_op
+                      << R"(,"allocs_per_op":)" << result.allocs_per_op
+                      << R"(,"ops_per_sec":)" << result.ops_per_sec
+                      << R"(,"nodes_per_op":)" << result.nodes_per_op
+                      << R"(,"bytes":)" << result.bytes << "}\n";
+        } else {
+            std::cout << result.name << ',' << result.level << ',' << result.iterations << ','
+                      << result.ns_per_op << ',' << result.allocs_per_op << ','
+                      << result.ops_per_sec << ',' << result.nodes_per_op << ',' << result.bytes
+                      << '\n';
+        }
+    }
+}
+
+BenchOptions read_options(int argc, char *argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--json") {
+            options.json = true;
+        } else if (arg == "--levels" and i + 1 < argc) {
+            options.levels_dir = argv[++i];
+        } else if (arg == "--filter" and i + 1 < argc) {
+            options.filter = argv[++i];
+        } else if (arg == "--min-time-ms" and i + 1 < argc) {
+            options.min_time_ms = std::stod(argv[++i]);
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--json] [--levels <dir>] [--filter <level substring>]"
+                         " [--min-time-ms <ms>]\n";
+            std::exit(arg == "--help" ? 0 : 1);
+        }
+    }
+    return options;
+}
+} // namespace
+
+int main(int argc, char *argv[]) {
+    auto options = read_options(argc, argv);
+    auto level_files = snaze::get_files_from_directory(options.levels_dir);
+    std::sort(level_files.begin(), level_files.end());
+    for (size_t side : {128, 512, 1024}) {
+        level_files.push_back(write_synthetic_maze(side));
+    }
+    std::vector<BenchResult> results;
+    for (const auto &level_file : level_files) {
+        if (level_file.find(options.filter) == std::string::npos) {
+            continue;
+        }
+        bench_level(level_file, options, results);
+    }
+    write_results(results, options.json);
+    return 0;
+}
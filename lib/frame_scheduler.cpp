@@ -0,0 +1,28 @@
+#include "frame_scheduler.hpp"
+
+#include <chrono>
+#include <thread>
+
+void FrameScheduler::rate(double ticks_per_second) {
+    m_period = Clock::duration::zero();
+    if (ticks_per_second > 0) {
+        m_period = std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(1.0 / ticks_per_second));
+    }
+}
+
+void FrameScheduler::wait_next_tick() {
+    auto now = Clock::now();
+    if (not m_started) {
+        m_deadline = now;
+        m_started = true;
+    }
+    m_deadline += m_period;
+    ++m_ticks;
+    if (m_deadline < now) {
+        ++m_overruns;
+        m_deadline = now;
+        return;
+    }
+    std::this_thread::sleep_until(m_deadline);
+}
@@ -0,0 +1,43 @@
+#ifndef FRAME_SCHEDULER_HPP
+#define FRAME_SCHEDULER_HPP
+
+#include <chrono>
+#include <cstddef>
+
+/**
+ * @brief Fixed timestep scheduler for a game loop.
+ *
+ * Ticks are scheduled on absolute deadlines, one period apart, and the loop sleeps until the
+ * next deadline, so the time spent doing the tick work doesn't add up to the period. A tick
+ * whose work took longer than the period is counted as an overrun, and the schedule restarts
+ * from that moment instead of bursting to catch up. The period has nanosecond resolution, so
+ * rates above 1000 ticks per second work as well.
+ */
+class FrameScheduler {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    /// Constructor, a non positive `ticks_per_second` means no pacing at all
+    explicit FrameScheduler(double ticks_per_second = 0) { rate(ticks_per_second); }
+    /// Changes the tick rate, taking effect from the next tick
+    void rate(double ticks_per_second);
+    /// Forgets the schedule, so the next tick starts a new one (e.g. after the loop was paused)
+    void reset() { m_started = false; }
+    /// Sleeps until the deadline of the next tick
+    void wait_next_tick();
+    /// Returns the tick period
+    [[nodiscard]] Clock::duration period() const { return m_period; }
+    /// Returns how many ticks have been waited
+    [[nodiscard]] size_t ticks() const { return m_ticks; }
+    /// Returns how many ticks missed their deadline
+    [[nodiscard]] size_t overruns() const { return m_overruns; }
+
+  private:
+    Clock::duration m_period{0};   //!< Time between two tick deadlines
+    Clock::time_point m_deadline;  //!< Deadline of the last waited tick
+    bool m_started{false};         //!< Tells if `m_deadline` belongs to the current schedule
+    size_t m_ticks{0};             //!< Ticks waited so far
+    size_t m_overruns{0};          //!< Ticks that missed their deadline
+};
+
+#endif // !FRAME_SCHEDULER_HPP
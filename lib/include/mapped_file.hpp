@@ -0,0 +1,33 @@
+#ifndef MAPPED_FILE_HPP
+#define MAPPED_FILE_HPP
+
+#include <cstddef>
+#include <string>
+
+/**
+ * @brief Read-only memory mapping of a whole file.
+ *
+ * The file contents are reachable through `data()` for as long as the object lives, paged in by
+ * the kernel on first access, with no copy into user buffers. Empty files are not mapped at all,
+ * `data()` is null for them.
+ */
+class MappedFile {
+  public:
+    /// Maps `path`, throws `std::runtime_error` when it can't be opened or mapped
+    explicit MappedFile(const std::string &path);
+    /// Unmaps the file
+    ~MappedFile();
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    /// Returns the first byte of the file
+    [[nodiscard]] const unsigned char *data() const { return m_data; }
+    /// Returns the file size in bytes
+    [[nodiscard]] size_t size() const { return m_size; }
+
+  private:
+    const unsigned char *m_data{nullptr}; //!< Start of the mapping
+    size_t m_size{0};                     //!< Length of the mapping
+};
+
+#endif // !MAPPED_FILE_HPP
@@ -0,0 +1,73 @@
+#ifndef RNG_HPP
+#define RNG_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <random>
+
+/**
+ * @brief Small and fast pseudo random generator, xoshiro256**.
+ *
+ * The state is filled from a 64 bit seed through splitmix64, so close seeds (like the seed of a
+ * run plus a game number) still give unrelated sequences. The same seed always gives the same
+ * sequence, on every platform.
+ */
+class Rng {
+  public:
+    /// Generator seeded with `seed`
+    explicit Rng(uint64_t seed = 0) { this->seed(seed); }
+
+    /// Returns a seed drawn from the system entropy source, for runs not asked for a seed
+    static uint64_t random_seed() {
+        std::random_device device;
+        return (uint64_t{device()} << 32) | device();
+    }
+    /// Restarts the sequence of `seed`
+    void seed(uint64_t seed) {
+        for (auto &word : m_state) {
+            seed += 0x9e3779b97f4a7c15ULL;
+            auto mixed = seed;
+            mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+            mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebULL;
+            word = mixed ^ (mixed >> 31);
+        }
+    }
+    /// Returns the generator state, to go on from it later
+    [[nodiscard]] const std::array<uint64_t, 4> &state() const { return m_state; }
+    /// Goes on from a state taken before
+    void state(const std::array<uint64_t, 4> &state) { m_state = state; }
+    /// Returns the next 64 random bits
+    uint64_t next() {
+        const auto result = rotl(m_state[1] * 5, 7) * 9;
+        const auto shifted = m_state[1] << 17;
+        m_state[2] ^= m_state[0];
+        m_state[3] ^= m_state[1];
+        m_state[1] ^= m_state[2];
+        m_state[0] ^= m_state[3];
+        m_state[2] ^= shifted;
+        m_state[3] = rotl(m_state[3], 45);
+        return result;
+    }
+    /// Returns a uniform number in [0, `bound`), `bound` being positive and below 2^32. It takes
+    /// the high half of a 32x32 bit product instead of a modulo, retrying the rare draws that
+    /// would bias it.
+    size_t below(size_t bound) {
+        const auto range = static_cast<uint32_t>(bound);
+        const auto threshold = static_cast<uint32_t>(0U - range) % range;
+        while (true) {
+            const auto product = (next() >> 32) * range;
+            if (static_cast<uint32_t>(product) >= threshold) {
+                return static_cast<size_t>(product >> 32);
+            }
+        }
+    }
+
+  private:
+    std::array<uint64_t, 4> m_state{}; //!< Generator state, never all zeros
+
+    /// Rotates `x` left by `k` bits
+    static uint64_t rotl(uint64_t x, int k) { return (x << k) | (x >> (64 - k)); }
+};
+
+#endif // !RNG_HPP
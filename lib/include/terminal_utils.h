@@ -1,7 +1,10 @@
 #ifndef TERMINAL_UTILS_H
 #define TERMINAL_UTILS_H
 
+#include <cstddef>
 #include <cstdlib>
+#include <deque>
+#include <optional>
 #include <string>
 #include <sys/select.h>
 #include <termios.h>
@@ -68,4 +71,41 @@ int get_terminal_width();
  */
 void print_centered(const std::string &text);
 
+/**
+ * @brief Persistent raw mode session with a non-blocking key queue.
+ *
+ * While entered, the terminal stays with canonical mode and echo disabled, so no termios
+ * call is needed per frame. Output processing is left untouched, so newlines still work as
+ * usual. Every pending keystroke is drained with `poll()` into a small queue, this way keys
+ * pressed between frames are kept instead of lost. The original terminal settings are restored
+ * when leaving, on destruction and when the program is interrupted by SIGINT or SIGTERM.
+ */
+class RawInput {
+  public:
+    RawInput() = default;
+    RawInput(const RawInput &) = delete;
+    RawInput &operator=(const RawInput &) = delete;
+    /// Leaves the raw mode, if entered
+    ~RawInput() { leave(); }
+
+    /// Puts the terminal in raw mode, does nothing if already entered
+    void enter();
+    /// Restores the terminal original settings and drops the queued keys
+    void leave();
+    /// Tells if the terminal is in raw mode
+    [[nodiscard]] bool active() const { return m_active; }
+    /// Reads every pending keystroke without blocking. When the queue is full newer keys are
+    /// dropped, so the ones pressed first are honoured first.
+    void drain();
+    /// Pops the oldest queued keystroke, if any
+    std::optional<char> next_key();
+
+  private:
+    static constexpr size_t MAX_QUEUED_KEYS = 16; //!< Capacity of the key queue
+
+    struct termios m_original {}; //!< Terminal settings before entering the raw mode
+    bool m_active{false};         //!< Tells if the terminal is in raw mode
+    std::deque<char> m_keys;      //!< Keystrokes read but not consumed yet
+};
+
 #endif // !TERMINAL_UTILS_H
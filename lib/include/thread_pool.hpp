@@ -0,0 +1,65 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/**
+ * @brief A fixed size pool of threads with work stealing.
+ *
+ * Every worker owns a task deque. Submitted tasks are spread over the deques in round-robin,
+ * a worker takes tasks from the back of its own deque and, when it runs dry, steals from the
+ * front of the others. So long tasks on one worker don't leave the others idle.
+ */
+class ThreadPool {
+  public:
+    using Task = std::function<void()>;
+
+    /// Starts `threads` workers, or one per hardware thread when `threads` is zero
+    explicit ThreadPool(size_t threads = 0);
+    /// Finishes the queued tasks and joins every worker
+    ~ThreadPool();
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    /// Queues `task` to be run by some worker
+    void submit(Task task);
+    /// Blocks until every submitted task has finished. If some task has thrown, the first
+    /// exception is rethrown here.
+    void wait();
+    /// Returns the amount of workers
+    [[nodiscard]] size_t size() const { return m_threads.size(); }
+
+  private:
+    /// A worker task deque
+    struct TaskQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<TaskQueue>> m_queues; //!< One deque per worker
+    std::vector<std::thread> m_threads;               //!< The workers
+    std::mutex m_mutex;                   //!< Guards `m_queued`, `m_stop` and `m_error`
+    std::condition_variable m_work_cv;    //!< Signals workers there's something queued
+    std::condition_variable m_idle_cv;    //!< Signals `wait` that every task has finished
+    size_t m_queued{0};                   //!< Tasks submitted but not taken by a worker yet
+    std::atomic<size_t> m_pending{0};     //!< Tasks submitted but not finished yet
+    std::atomic<size_t> m_next_queue{0};  //!< Round-robin counter used by `submit`
+    bool m_stop{false};                   //!< Tells the workers to leave once idle
+    std::exception_ptr m_error;           //!< First exception thrown by a task
+
+    /// Worker loop of the worker `id`
+    void work(size_t id);
+    /// Takes a task from the worker `id` own deque or steals one from the others
+    bool take_task(size_t id, Task &task);
+};
+
+#endif // !THREAD_POOL_HPP
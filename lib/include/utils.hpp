@@ -1,8 +1,15 @@
 #ifndef UTILS_HPP
 #define UTILS_HPP
 
+#include <string>
+
+/// Escape sequence that moves the cursor home and clears the screen
+constexpr char CLEAR_SCREEN[] = "\033[H\033[2J";
+
 void cin_clear();
 void clear_screen();
+/// Writes `frame` to the standard output in a single write(2), looping only on partial writes
+void write_frame(const std::string &frame);
 bool read_yes_no_confirmation(bool yes_preffered);
 void read_enter_to_proceed();
 
@@ -31,9 +31,17 @@ snaze::Settings convert_map_to_settings(const Parser::IniUMap &map) {
             } else if (key == "snake_lives") {
                 settings.lives = std::stoi(val);
             } else if (key == "game_fps") {
-                settings.fps = std::stoi(val);
+                settings.fps = std::stod(val);
             } else if (key == "player_type") {
                 settings.player_type = val;
+            } else if (key == "distance_budget_kb") {
+                settings.distance_budget_kb = std::stoul(val);
+            } else if (key == "seed") {
+                settings.seed = std::stoull(val);
+            } else if (key == "replay_dir") {
+                settings.replay_dir = val;
+            } else if (key == "think_budget_ms") {
+                settings.think_budget_ms = std::stod(val);
             } else {
                 throw std::invalid_argument("Unpredicted value");
             }
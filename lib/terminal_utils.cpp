@@ -1,6 +1,9 @@
 #include "terminal_utils.h"
+#include <csignal>
 #include <cstring>
 #include <iostream>
+#include <optional>
+#include <poll.h>
 #include <string>
 #include <sys/ioctl.h>
 #include <unistd.h>
@@ -53,3 +56,67 @@ void print_centered(const std::string &text) {
         std::cout << text << std::endl; // Text is too long to center
     }
 }
+
+namespace {
+struct termios raw_input_original;          //!< Settings restored by the signal handler
+volatile sig_atomic_t raw_input_active = 0; //!< Tells the handler if there's something to restore
+
+void restore_and_reraise(int signal) {
+    if (raw_input_active != 0) {
+        tcsetattr(STDIN_FILENO, TCSANOW, &raw_input_original);
+    }
+    std::signal(signal, SIG_DFL);
+    std::raise(signal);
+}
+} // namespace
+
+void RawInput::enter() {
+    if (m_active or tcgetattr(STDIN_FILENO, &m_original) != 0) {
+        return;
+    }
+    struct termios raw = m_original;
+    raw.c_lflag &= ~static_cast<tcflag_t>(ICANON | ECHO);
+    raw.c_cc[VMIN] = 1;
+    raw.c_cc[VTIME] = 0;
+    raw_input_original = m_original;
+    raw_input_active = 1;
+    std::signal(SIGINT, restore_and_reraise);
+    std::signal(SIGTERM, restore_and_reraise);
+    tcsetattr(STDIN_FILENO, TCSANOW, &raw);
+    m_active = true;
+}
+
+void RawInput::leave() {
+    m_keys.clear();
+    if (not m_active) {
+        return;
+    }
+    tcsetattr(STDIN_FILENO, TCSANOW, &m_original);
+    raw_input_active = 0;
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    m_active = false;
+}
+
+void RawInput::drain() {
+    struct pollfd stdin_poll = {STDIN_FILENO, POLLIN, 0};
+    char buffer[MAX_QUEUED_KEYS];
+    while (poll(&stdin_poll, 1, 0) > 0 and (stdin_poll.revents & POLLIN) != 0) {
+        auto bytes = read(STDIN_FILENO, buffer, sizeof(buffer));
+        if (bytes <= 0) {
+            return;
+        }
+        for (ssize_t i = 0; i < bytes and m_keys.size() < MAX_QUEUED_KEYS; ++i) {
+            m_keys.push_back(buffer[i]);
+        }
+    }
+}
+
+std::optional<char> RawInput::next_key() {
+    if (m_keys.empty()) {
+        return std::nullopt;
+    }
+    auto key = m_keys.front();
+    m_keys.pop_front();
+    return key;
+}
@@ -0,0 +1,105 @@
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+ThreadPool::ThreadPool(size_t threads) {
+    if (threads == 0) {
+        threads = std::max(1U, std::thread::hardware_concurrency());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        m_queues.push_back(std::make_unique<TaskQueue>());
+    }
+    for (size_t i = 0; i < threads; ++i) {
+        m_threads.emplace_back(&ThreadPool::work, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard lock(m_mutex);
+        m_stop = true;
+    }
+    m_work_cv.notify_all();
+    for (auto &thread : m_threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(Task task) {
+    ++m_pending;
+    {
+        std::lock_guard lock(m_mutex);
+        ++m_queued;
+    }
+    auto &queue = *m_queues[m_next_queue++ % m_queues.size()];
+    {
+        std::lock_guard lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+    }
+    m_work_cv.notify_one();
+}
+
+void ThreadPool::wait() {
+    std::unique_lock lock(m_mutex);
+    m_idle_cv.wait(lock, [this] { return m_pending == 0; });
+    if (m_error) {
+        std::rethrow_exception(std::exchange(m_error, nullptr));
+    }
+}
+
+bool ThreadPool::take_task(size_t id, Task &task) {
+    {
+        auto &own = *m_queues[id];
+        std::lock_guard lock(own.mutex);
+        if (not own.tasks.empty()) {
+            task = std::move(own.tasks.back());
+            own.tasks.pop_back();
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < m_queues.size(); ++offset) {
+        auto &victim = *m_queues[(id + offset) % m_queues.size()];
+        std::lock_guard lock(victim.mutex);
+        if (not victim.tasks.empty()) {
+            task = std::move(victim.tasks.front());
+            victim.tasks.pop_front();
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::work(size_t id) {
+    while (true) {
+        Task task;
+        if (take_task(id, task)) {
+            {
+                std::lock_guard lock(m_mutex);
+                --m_queued;
+            }
+            try {
+                task();
+            } catch (...) {
+                std::lock_guard lock(m_mutex);
+                if (not m_error) {
+                    m_error = std::current_exception();
+                }
+            }
+            if (--m_pending == 0) {
+                std::lock_guard lock(m_mutex);
+                m_idle_cv.notify_all();
+            }
+            continue;
+        }
+        std::unique_lock lock(m_mutex);
+        // A task may be counted but still on its way to a deque, in that case just try again
+        m_work_cv.wait(lock, [this] { return m_stop or m_queued > 0; });
+        if (m_stop and m_queued == 0) {
+            return;
+        }
+    }
+}
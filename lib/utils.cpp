@@ -1,19 +1,33 @@
 #include "utils.hpp"
 #include <algorithm>
+#include <cerrno>
 #include <iostream>
 #include <limits>
+#include <string>
+#include <unistd.h>
 
 void cin_clear() {
     std::cin.clear();
     std::cin.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
 }
 
-void clear_screen() {
-#ifdef _WIN32
-    system("cls");
-#else
-    system("clear");
-#endif
+void clear_screen() { write_frame(CLEAR_SCREEN); }
+
+void write_frame(const std::string &frame) {
+    std::cout.flush(); // Anything still buffered must reach the terminal before the frame
+    const char *data = frame.data();
+    size_t remaining = frame.size();
+    while (remaining > 0) {
+        auto written = write(STDOUT_FILENO, data, remaining);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+        data += written;
+        remaining -= static_cast<size_t>(written);
+    }
 }
 
 bool read_yes_no_confirmation(bool yes_preffered = true) {
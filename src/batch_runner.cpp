@@ -0,0 +1,132 @@
+#include "batch_runner.hpp"
+#include "level_pack.hpp"
+#include "simulation.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <utility>
+#include <vector>
+
+namespace snaze {
+void LevelSummary::add(const GameResult &result) {
+    ++games;
+    won += (result.outcome == GameOutcome::Won) ? 1 : 0;
+    lost += (result.outcome == GameOutcome::Lost) ? 1 : 0;
+    stalled += (result.outcome == GameOutcome::Stalled) ? 1 : 0;
+    food_eaten += result.food_eaten;
+    lives_lost += result.lives_lost;
+    ticks += result.ticks;
+    wall_ms += result.wall_ms;
+    searches += result.searches;
+    nodes_expanded += result.nodes_expanded;
+}
+
+BatchReport run_batch(const HeadlessOptions &options) {
+    auto start_time = std::chrono::steady_clock::now();
+    BatchReport report;
+    report.seed = options.settings.seed;
+    const auto &level_files = options.level_files;
+    const auto bots = options.bot_modes.size();
+    const auto games = options.games_per_level;
+    // One summary per level and bot, those of the skipped levels are dropped once done
+    std::vector<LevelSummary> summaries(level_files.size() * bots);
+    std::vector<char> played(level_files.size(), 0);
+    std::mutex summaries_mutex;
+    {
+        ThreadPool pool(options.threads);
+        report.threads = pool.size();
+        // Seeded by the game number, so the results don't depend on the scheduling
+        auto play = [&options, &summaries, &summaries_mutex, bots, games](
+                        size_t level_idx, const Maze &level, size_t bot_idx, size_t game) {
+            auto summary_idx = level_idx * bots + bot_idx;
+            auto game_number = summary_idx * games + game;
+            Simulation simulation(options.level_files[level_idx], level, options.settings,
+                                  options.bot_modes[bot_idx], options.max_ticks,
+                                  options.settings.seed + game_number);
+            if (not options.replay_dir.empty()) {
+                simulation.record(replay_file(options.replay_dir, game_number));
+            }
+            auto result = simulation.run();
+            std::lock_guard lock(summaries_mutex);
+            summaries[summary_idx].add(result);
+        };
+        // With fewer levels than workers, the games of a level are spread over the pool, sharing
+        // the level until the last one is done. Otherwise each task plays the games of the levels
+        // it loads, so only the levels being played are in memory.
+        const bool spread_games = level_files.size() < pool.size();
+        // Levels go in runs, so each task reads the levels of a pack through one open file
+        const auto run = std::max<size_t>(1, level_files.size() / (pool.size() * 4));
+        for (size_t first = 0; first < level_files.size(); first += run) {
+            pool.submit([&, first, run] {
+                LevelLoader loader;
+                for (auto idx = first; idx < std::min(first + run, level_files.size()); ++idx) {
+                    std::shared_ptr<const Maze> level;
+                    try {
+                        level = std::make_shared<const Maze>(loader.load(
+                            level_files[idx], options.settings.distance_budget_kb << 10));
+                    } catch (const std::exception &error) {
+                        std::cerr << "Skipping unreadable level " << level_files[idx] << ": "
+                                  << error.what() << '\n';
+                        continue;
+                    }
+                    if (not level->issues().playable()) {
+                        std::cerr << "Skipping unplayable level " << level_files[idx] << '\n';
+                        continue;
+                    }
+                    played[idx] = 1;
+                    const auto *distances = level->distances();
+                    for (size_t bot_idx = 0; bot_idx < bots; ++bot_idx) {
+                        auto &summary = summaries[idx * bots + bot_idx];
+                        summary.level = level_files[idx];
+                        summary.bot_mode = options.bot_modes[bot_idx];
+                        if (distances != nullptr) {
+                            summary.distance_kb = (distances->memory_bytes() + 1023) >> 10;
+                            summary.distance_ms = distances->build_ms();
+                        }
+                    }
+                    for (size_t bot_idx = 0; bot_idx < bots; ++bot_idx) {
+                        for (size_t game = 0; game < games; ++game) {
+                            if (spread_games) {
+                                pool.submit([&play, level, idx, bot_idx, game] {
+                                    play(idx, *level, bot_idx, game);
+                                });
+                            } else {
+                                play(idx, *level, bot_idx, game);
+                            }
+                        }
+                    }
+                }
+            });
+        }
+        pool.wait();
+    }
+    for (size_t idx = 0; idx < summaries.size(); ++idx) {
+        if (played[idx / bots] != 0) {
+            report.summaries.push_back(std::move(summaries[idx]));
+        }
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    report.wall_ms = elapsed.count();
+    return report;
+}
+
+void write_report(const BatchReport &report, std::ostream &os) {
+    os << "level,bot,games,won,lost,stalled,food_eaten,lives_lost,ticks,wall_ms,searches,"
+          "nodes_expanded,distance_kb,distance_ms\n";
+    for (const auto &summary : report.summaries) {
+        os << summary.level << ',' << to_string(summary.bot_mode) << ',' << summary.games << ','
+           << summary.won << ',' << summary.lost << ',' << summary.stalled << ','
+           << summary.food_eaten << ',' << summary.lives_lost << ',' << summary.ticks << ','
+           << summary.wall_ms << ',' << summary.searches << ',' << summary.nodes_expanded << ','
+           << summary.distance_kb << ',' << summary.distance_ms << '\n';
+    }
+    os.flush();
+}
+} // namespace snaze
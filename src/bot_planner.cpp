@@ -0,0 +1,80 @@
+#include "bot_planner.hpp"
+#include "simulation.hpp"
+
+#include <utility>
+
+namespace snaze {
+BotPlanner::~BotPlanner() {
+    if (m_pending.valid()) {
+        m_pending.wait();
+    }
+}
+
+void BotPlanner::reset(const Maze &maze, BotMode mode) {
+    if (m_pending.valid()) {
+        m_pending.wait();
+        m_pending = {};
+    }
+    m_maze = maze;
+    m_snake.reset(m_maze);
+    m_bot.mode(mode);
+    m_bot.forget();
+}
+
+void BotPlanner::request(const Maze &maze, const Snake &snake, const std::deque<Direction> &moves,
+                         const Rng &rng, const Rng &bot_rng, const SearchLimit &limit) {
+    if (m_pending.valid()) {
+        return;
+    }
+    // Everything the worker reads is copied, its maze, snake and bot are only its own
+    m_pending = std::async(std::launch::async, &BotPlanner::plan, this, maze.food(),
+                           snake.body(), snake.head_direction, moves, rng, bot_rng, limit);
+}
+
+BotPlanner::Plan BotPlanner::take(const Maze &maze, const Snake &snake, const Rng &rng,
+                                  const Rng &bot_rng,
+                                  std::chrono::duration<double, std::milli> budget) {
+    SearchLimit limit;
+    if (budget.count() > 0) {
+        // The other half is left to hand the plan over
+        limit.deadline =
+            std::chrono::steady_clock::now() +
+            std::chrono::duration_cast<std::chrono::steady_clock::duration>(budget / 2);
+    }
+    request(maze, snake, {}, rng, bot_rng, limit);
+    // No plan is asked for from the current state then, the snake makes the fallback move
+    // before it would be done, so it would be stale again
+    auto fallback = [&maze, &snake, &bot_rng] {
+        return Plan{{SnakeBot::fallback_move(maze, snake)}, bot_rng, true};
+    };
+    if (budget.count() > 0 and m_pending.wait_for(budget) != std::future_status::ready) {
+        return fallback(); // The plan is thrown away by the next `take`, once done
+    }
+    auto result = m_pending.get();
+    if (result.body != snake.body() or result.food != maze.food()) {
+        return fallback();
+    }
+    return std::move(result.plan);
+}
+
+BotPlanner::Result BotPlanner::plan(Position food, std::deque<Position> body, Direction direction,
+                                    std::deque<Direction> moves, Rng rng, Rng bot_rng,
+                                    SearchLimit limit) {
+    m_maze.place_food(food);
+    m_snake.restore(body, direction);
+    for (const auto &move : moves) {
+        m_snake.head_direction = move;
+        auto tick_outcome = advance_snake(m_maze, m_snake);
+        if (tick_outcome == TickOutcome::Crashed) {
+            break; // The life ends there, the plan is never taken
+        }
+        if (tick_outcome == TickOutcome::Ate) {
+            m_maze.random_food_position(m_snake.open_cells(), rng);
+        }
+    }
+    Result result{m_snake.body(), m_maze.food(), Plan{{}, bot_rng}};
+    m_bot.think(m_maze, m_snake, result.plan.bot_rng, limit);
+    result.plan.moves = std::move(m_bot.solution.value());
+    return result;
+}
+} // namespace snaze
@@ -0,0 +1,75 @@
+#include "diff_renderer.hpp"
+#include "maze.hpp"
+#include "snake.hpp"
+#include "utils.hpp"
+
+#include <algorithm>
+#include <string>
+#include <utility>
+
+namespace {
+/// Escape sequence that moves the cursor to the 1-based `row` and `col`
+std::string cursor_to(size_t row, size_t col) {
+    return "\033[" + std::to_string(row) + ';' + std::to_string(col) + 'H';
+}
+
+bool vertical(const snaze::Direction &dir) {
+    return dir == snaze::Direction::Up or dir == snaze::Direction::Down;
+}
+} // namespace
+
+namespace snaze {
+std::string DiffRenderer::full_frame(const std::string &header, const Maze &maze,
+                                     const Direction &head_direction) const {
+    std::string out = CLEAR_SCREEN + header;
+    for (size_t row = 0; row < maze.height(); ++row) {
+        for (size_t col = 0; col < maze.width(); ++col) {
+            out += Maze::str_cell_in_game(m_current[row * maze.width() + col], head_direction);
+        }
+        out += '\n';
+    }
+    out += '\n';
+    return out;
+}
+
+std::string DiffRenderer::frame(const std::string &header, const Maze &maze,
+                                const Snake &snake) {
+    maze.paint_in_game(snake.body(), m_current);
+    const auto head_direction = snake.head_direction;
+    const auto header_rows = static_cast<size_t>(std::count(header.cbegin(), header.cend(), '\n'));
+    std::string out;
+    if (not m_valid or m_width != maze.width() or m_previous.size() != m_current.size() or
+        header_rows != m_header_rows) {
+        out = full_frame(header, maze, head_direction);
+    } else {
+        if (header != m_previous_header) {
+            out += "\033[H";
+            for (const auto &chr : header) {
+                out += (chr == '\n') ? "\033[K\n" : std::string(1, chr);
+            }
+        }
+        const auto head = maze.index(snake.body().front());
+        const bool head_turned = vertical(head_direction) != vertical(m_previous_head_direction);
+        size_t cursor = m_current.size(); // Cell under the cursor, none at first
+        for (size_t idx = 0; idx < m_current.size(); ++idx) {
+            if (m_current[idx] == m_previous[idx] and not(idx == head and head_turned)) {
+                continue;
+            }
+            if (idx != cursor) {
+                out += cursor_to(header_rows + idx / m_width + 1, idx % m_width + 1);
+            }
+            out += Maze::str_cell_in_game(m_current[idx], head_direction);
+            cursor = (idx % m_width + 1 < m_width) ? idx + 1 : m_current.size();
+        }
+        // Leaves the cursor where a full frame would have left it
+        out += cursor_to(header_rows + maze.height() + 2, 1);
+    }
+    std::swap(m_previous, m_current);
+    m_previous_header = header;
+    m_header_rows = header_rows;
+    m_previous_head_direction = head_direction;
+    m_width = maze.width();
+    m_valid = true;
+    return out;
+}
+} // namespace snaze
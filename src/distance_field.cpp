@@ -0,0 +1,146 @@
+#include "distance_field.hpp"
+#include "maze.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <vector>
+
+namespace {
+constexpr std::array directions{snaze::Direction::Up, snaze::Direction::Down,
+                                snaze::Direction::Left, snaze::Direction::Right};
+} // namespace
+
+namespace snaze {
+DistanceField::DistanceField(const Maze &maze, size_t budget_bytes) {
+    auto start_time = std::chrono::steady_clock::now();
+    m_cells = maze.width() * maze.height();
+    if (m_cells == 0 or m_cells * sizeof(uint32_t) > budget_bytes) {
+        return;
+    }
+    std::vector<uint32_t> queue(m_cells);
+    label_components(maze, queue);
+    auto left = budget_bytes - m_cells * sizeof(uint32_t);
+
+    if (m_cells * sizeof(uint32_t) + m_free * m_free * sizeof(Distance) <= left) {
+        m_exact = true;
+        m_slot.assign(m_cells, NO_COMPONENT);
+        uint32_t slot = 0;
+        for (size_t cell = 0; cell < m_cells; ++cell) {
+            if (not maze.is_wall(cell)) {
+                m_slot[cell] = slot++;
+            }
+        }
+        m_distances.resize(m_free * m_free);
+        for (size_t cell = 0; cell < m_cells; ++cell) {
+            if (m_slot[cell] != NO_COMPONENT) {
+                breadth_first(maze, static_cast<uint32_t>(cell),
+                              &m_distances[m_slot[cell] * m_free], true, queue);
+            }
+        }
+    } else {
+        auto count = std::min(MAX_LANDMARKS, left / (m_cells * sizeof(Distance)));
+        m_distances.resize(count * m_cells);
+        // Farthest point selection: every landmark is the cell farthest from the ones before,
+        // starting from the cell farthest from the spawn. So they end up spread over the
+        // borders of the spawn component, where the triangle inequality bounds best.
+        std::vector<Distance> nearest(m_cells);
+        breadth_first(maze, static_cast<uint32_t>(maze.index(maze.start())), nearest.data(),
+                      false, queue);
+        while (m_landmarks.size() < count) {
+            size_t farthest = m_cells;
+            for (size_t cell = 0; cell < m_cells; ++cell) {
+                if (nearest[cell] != UNREACHABLE and
+                    (farthest == m_cells or nearest[cell] > nearest[farthest])) {
+                    farthest = cell;
+                }
+            }
+            if (farthest == m_cells or (not m_landmarks.empty() and nearest[farthest] == 0)) {
+                break; // Every reachable cell is already a landmark
+            }
+            auto *row = &m_distances[m_landmarks.size() * m_cells];
+            m_landmarks.push_back(static_cast<uint32_t>(farthest));
+            breadth_first(maze, static_cast<uint32_t>(farthest), row, false, queue);
+            for (size_t cell = 0; cell < m_cells; ++cell) {
+                nearest[cell] = std::min(nearest[cell], row[cell]);
+            }
+        }
+        m_distances.resize(m_landmarks.size() * m_cells);
+        m_distances.shrink_to_fit();
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    m_build_ms = elapsed.count();
+}
+
+size_t DistanceField::memory_bytes() const {
+    return (m_component.size() + m_slot.size() + m_landmarks.size()) * sizeof(uint32_t) +
+           m_distances.size() * sizeof(Distance);
+}
+
+uint32_t DistanceField::lower_bound(size_t from, size_t to) const {
+    if (m_exact) {
+        auto distance = m_distances[m_slot[from] * m_free + m_slot[to]];
+        return (distance == UNREACHABLE) ? 0 : distance;
+    }
+    uint32_t bound = 0;
+    for (size_t landmark = 0; landmark < m_landmarks.size(); ++landmark) {
+        const auto *row = &m_distances[landmark * m_cells];
+        if (row[from] == UNREACHABLE or row[to] == UNREACHABLE) {
+            continue;
+        }
+        uint32_t difference = (row[from] > row[to]) ? row[from] - row[to] : row[to] - row[from];
+        bound = std::max(bound, difference);
+    }
+    return bound;
+}
+
+void DistanceField::label_components(const Maze &maze, std::vector<uint32_t> &queue) {
+    m_component.assign(m_cells, NO_COMPONENT);
+    uint32_t component = 0;
+    for (size_t seed = 0; seed < m_cells; ++seed) {
+        if (maze.is_wall(seed) or m_component[seed] != NO_COMPONENT) {
+            continue;
+        }
+        size_t queue_head = 0;
+        size_t queue_tail = 0;
+        m_component[seed] = component;
+        queue[queue_tail++] = static_cast<uint32_t>(seed);
+        while (queue_head < queue_tail) {
+            auto current = queue[queue_head++];
+            ++m_free;
+            for (const auto &dir : directions) {
+                auto next = maze.step(current, dir);
+                if (maze.is_wall(next) or m_component[next] != NO_COMPONENT) {
+                    continue;
+                }
+                m_component[next] = component;
+                queue[queue_tail++] = static_cast<uint32_t>(next);
+            }
+        }
+        ++component;
+    }
+}
+
+void DistanceField::breadth_first(const Maze &maze, uint32_t source, Distance *out, bool by_slot,
+                                  std::vector<uint32_t> &queue) const {
+    auto at = [&](size_t cell) -> Distance & { return out[by_slot ? m_slot[cell] : cell]; };
+    std::fill(out, out + (by_slot ? m_free : m_cells), UNREACHABLE);
+    size_t queue_head = 0;
+    size_t queue_tail = 0;
+    at(source) = 0;
+    queue[queue_tail++] = source;
+    while (queue_head < queue_tail) {
+        auto current = queue[queue_head++];
+        auto next_distance = static_cast<Distance>(std::min<uint32_t>(at(current) + 1, FARTHEST));
+        for (const auto &dir : directions) {
+            auto next = maze.step(current, dir);
+            if (maze.is_wall(next) or at(next) != UNREACHABLE) {
+                continue;
+            }
+            at(next) = next_distance;
+            queue[queue_tail++] = static_cast<uint32_t>(next);
+        }
+    }
+}
+} // namespace snaze
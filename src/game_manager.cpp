@@ -1,21 +1,25 @@
 #include "game_manager.hpp"
 #include "maze.hpp"
+#include "simulation.hpp"
 #include "snake.hpp"
 #include "terminal_utils.h"
 #include "utils.hpp"
 
 #include <cstddef>
 #include <cstdlib>
-#include <experimental/random>
 #include <iostream>
 #include <stdexcept>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 namespace snaze {
 
 void SnazeManager::process() {
+    if (m_snaze_state != SnazeState::On) {
+        m_input.leave(); // The other states read whole lines from std::cin
+    }
     if (m_snaze_state == SnazeState::Init) {
     } else if (m_snaze_state == SnazeState::MainMenu) {
         m_menu_option = read_menu_option();
@@ -26,37 +30,42 @@ void SnazeManager::process() {
     } else if (m_snaze_state == SnazeState::BotMode) {
         m_bot_strategy = read_bot_option();
     } else if (m_snaze_state == SnazeState::GameStart) {
-        m_snake.reset();
-        m_maze.random_food_position();
-
+        if (not m_replay.has_value()) {
+            start_replay();
+        }
+        m_snake.reset(m_maze);
         if (m_snaze_mode == SnazeMode::Bot) {
-            m_snake.body.push_front(m_maze.start());
-            snake_bot_think(m_snake);
-            /*std::cerr << '\n'*/
-            /*<< m_maze.str_debug(m_snake_bot.solution.value(), m_snake.body.front());*/
-            /*std::this_thread::sleep_for(std::chrono::milliseconds(3000));*/
-            // exit(0);
+            m_snake.push_front(m_maze.start());
+            m_maze.random_food_position(m_snake.open_cells(), m_rng);
+            // The level may have changed, the first plan is made while the level is shown
+            m_planner.reset(m_maze, m_bot_strategy);
+            m_bot_moves.clear();
+            m_planner.request(m_maze, m_snake, m_bot_moves, m_rng, m_bot_rng, think_limit(0));
             return;
         }
         m_snake.head_direction = read_starting_direction();
-        m_snake.body.push_back(m_maze.start() + m_snake.head_direction);
+        if (m_replay.has_value()) {
+            if (opposite(m_snake.head_direction) == Direction::None) {
+                m_replay.reset(); // Not a move, the game can't be replayed
+            } else {
+                m_replay->push(m_snake.head_direction);
+            }
+        }
+        m_snake.push_back(m_maze.start() + m_snake.head_direction);
+        m_maze.random_food_position(m_snake.open_cells(), m_rng);
     } else if (m_snaze_state == SnazeState::On) {
         if (m_snaze_mode == SnazeMode::Player) {
-            set_terminal_mode();
-            if (kbhit() != 0) {
-                m_snake.head_direction = input(static_cast<char>(getch()), m_snake.head_direction);
+            m_input.enter();
+            m_input.drain();
+            while (auto keystroke = m_input.next_key()) {
+                auto direction = input(keystroke.value(), m_snake.head_direction);
+                if (direction != Direction::None and direction != m_snake.head_direction) {
+                    m_snake.head_direction = direction;
+                    break; // One turn per tick, the remaining keys are left to the next ticks
+                }
             }
-            reset_terminal_mode();
         } else if (m_snaze_mode == SnazeMode::Bot) {
-            if (m_snake_bot.solution.has_value() and m_snake_bot.solution.value().empty()) {
-                snake_bot_think(m_snake);
-                // std::cerr << '\n'
-                //           << m_maze.str_debug(m_snake_bot.solution.value(),
-                //           m_snake.body.front());
-                // std::this_thread::sleep_for(std::chrono::milliseconds(3000));
-            }
-            m_snake.head_direction = m_snake_bot.solution.value().front();
-            m_snake_bot.solution.value().pop_front();
+            m_snake.head_direction = next_bot_move();
         }
     } else if (m_snaze_state == SnazeState::Won or m_snaze_state == SnazeState::Lost) {
         m_snaze_state =
@@ -89,11 +98,16 @@ void SnazeManager::update() {
         } else {
             m_snaze_state = SnazeState::GameStart; // Playing manual
         }
-        // NOTE: Picking a random level
-        if (still_levels_available()) {
-            size_t random_idx = std::experimental::randint(0, (int)m_game_levels_files.size() - 1);
-            m_maze = Maze(m_game_levels_files[random_idx]);
-            m_game_levels_files.erase(m_game_levels_files.cbegin() + (long)random_idx);
+        // NOTE: The random level was loaded in the background, the one after it starts loading
+        auto level = m_levels.next();
+        m_replay.reset();
+        if (level.has_value()) {
+            m_level_file = std::move(level.value().file);
+            m_maze = std::move(level.value().maze);
+            // Each game draws from its own seed, so it plays the same again from its replay
+            m_game_seed = m_settings.seed + m_games++;
+            m_rng.seed(m_game_seed);
+            m_bot_rng.seed(~m_game_seed);
         } else if (m_remaining_snake_lives > 0) {
             m_snaze_state = SnazeState::Won;
         }
@@ -108,30 +122,29 @@ void SnazeManager::update() {
     } else if (m_snaze_state == SnazeState::GameStart) {
         m_snaze_state = SnazeState::On;
     } else if (m_snaze_state == SnazeState::On) {
-        bool ate = false;
-        auto updated_snake_head_position = update_snake_position();
-        if (m_maze.blocked(updated_snake_head_position, Direction::None) or
-            m_snake.is_snake_body(updated_snake_head_position)) {
+        if (m_replay.has_value()) {
+            m_replay->tick(m_snake.head_direction);
+        }
+        auto tick_outcome = advance_snake(m_maze, m_snake);
+        if (tick_outcome == TickOutcome::Crashed) {
             m_snaze_state = SnazeState::Damage;
-        } else if (m_maze.found_food(updated_snake_head_position)) {
+        } else if (tick_outcome == TickOutcome::Ate) {
             if (++m_eaten_food_amount_snake == m_settings.food_amount) {
                 m_snaze_state = SnazeState::Won;
+                finish_replay(true);
             }
-            m_maze.random_food_position();
-            ate = true;
-        }
-        if (not ate) {
-            m_snake.body.pop_back();
+            m_maze.random_food_position(m_snake.open_cells(), m_rng);
         }
     } else if (m_snaze_state == SnazeState::Won or m_snaze_state == SnazeState::Lost) {
         m_new_game = true;
     } else if (m_snaze_state == SnazeState::Damage) {
         if (--m_remaining_snake_lives == 0) {
             m_snaze_state = SnazeState::Lost;
+            finish_replay(false);
             return;
         }
         m_snaze_state = SnazeState::GameStart;
-        m_snake.reset();
+        m_snake.reset(m_maze);
         // HACK: Maybe reset food also cause still showing on screen
     } else {
         m_snaze_state = SnazeState::MainMenu;
@@ -139,7 +152,11 @@ void SnazeManager::update() {
 }
 
 void SnazeManager::render() {
-    clear_screen();
+    std::string frame; // The whole screen goes to the terminal in a single write
+    if (m_snaze_state != SnazeState::On) {
+        m_renderer.invalidate();
+        frame = CLEAR_SCREEN;
+    }
     if (m_snaze_state == SnazeState::MainMenu) {
         screen_title("Snaze Game 🐍");
         main_content(main_menu_mc());
@@ -160,7 +177,7 @@ void SnazeManager::render() {
         main_content(game_loop_info() + m_maze.str_symbols() + m_maze.str_spawn());
         interaction_msg(controls_im());
     } else if (m_snaze_state == SnazeState::On) {
-        main_content(game_loop_mc());
+        main_content(m_renderer.frame(game_loop_info() + '\n', m_maze, m_snake));
     } else if (m_snaze_state == SnazeState::Damage) {
         main_content(game_loop_info() + '\n' + m_maze.str_spawn());
         interaction_msg("The bot has suffered damage!!! Press <Enter> to continue");
@@ -178,23 +195,26 @@ void SnazeManager::render() {
         interaction_msg("Press <Enter> to go back");
     }
     if (not m_screen_title.empty()) {
-        std::cout << screen_title();
+        frame += screen_title();
         m_screen_title.clear();
     }
     if (not m_main_content.empty()) {
-        std::cout << main_content();
+        frame += main_content();
         m_main_content.clear();
     }
     if (not m_system_msg.empty()) {
-        std::cout << system_msg();
+        frame += system_msg();
         m_system_msg.clear();
     }
     if (not m_interaction_msg.empty()) {
-        std::cout << interaction_msg() << std::flush;
+        frame += interaction_msg();
         m_interaction_msg.clear();
     }
+    write_frame(frame);
     if (m_snaze_state == SnazeState::On) {
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000 / m_settings.fps));
+        m_scheduler.wait_next_tick();
+    } else {
+        m_scheduler.reset(); // Other states wait for input, the ticks restart after them
     }
 }
 } // namespace snaze
@@ -1,14 +1,18 @@
 #include "color.h"
 #include "game_manager.hpp"
 #include "ini_file_parser.h"
+#include "level_pack.hpp"
 #include "maze.hpp"
+#include "replay.hpp"
+#include "simulation.hpp"
 #include "snake.hpp"
 #include "terminal_utils.h"
 #include "utils.hpp"
 
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
 #include <cstdlib>
-#include <experimental/random>
 #include <filesystem>
 #include <iomanip>
 #include <iostream>
@@ -42,7 +46,7 @@ SnazeManager::SnazeMode SnazeManager::read_snaze_option() {
     return (SnazeMode)choice;
 }
 
-SnazeManager::BotMode SnazeManager::read_bot_option() {
+BotMode SnazeManager::read_bot_option() {
     int choice = 0;
     std::cin >> choice;
     if (std::cin.fail() or choice < (int)BotMode::Smart or choice > (int)BotMode::Dumb) {
@@ -84,14 +88,59 @@ Direction SnazeManager::input(char keystroke, Direction previous_direction) {
     return input_result;
 }
 
-void SnazeManager::snake_bot_think(const Snake &snake) {
-    m_snake_bot.solution = SnakeBot::solve(m_maze, snake);
-    if (not m_snake_bot.solution.has_value()) {
-        m_snake_bot.solution = SnakeBot::play_random(m_maze, snake);
-        if (!m_snake_bot.solution.has_value()) {
-            throw std::runtime_error("Something went wrong, while the bot was thinking");
-        }
+Direction SnazeManager::next_bot_move() {
+    if (m_bot_moves.empty()) {
+        auto plan = m_planner.take(m_maze, m_snake, m_rng, m_bot_rng,
+                                   std::chrono::duration<double, std::milli>(
+                                       m_settings.think_budget_ms));
+        m_bot_moves = std::move(plan.moves);
+        m_bot_rng = plan.bot_rng;
+        // The plan after this one is made while the snake follows it, or after the fallback move
+        m_planner.request(m_maze, m_snake, m_bot_moves, m_rng, m_bot_rng,
+                          think_limit(m_bot_moves.size()));
+    }
+    auto move = m_bot_moves.front();
+    m_bot_moves.pop_front();
+    return move;
+}
+
+SearchLimit SnazeManager::think_limit(size_t moves) const {
+    SearchLimit limit;
+    // Unpaced ticks (see `FrameScheduler`) give no time to plan by, the search isn't bounded
+    if (m_settings.think_budget_ms > 0 and m_settings.fps > 0) {
+        auto due = std::chrono::duration<double, std::milli>(
+            (1000.0 / m_settings.fps) * static_cast<double>(moves) +
+            m_settings.think_budget_ms / 2);
+        limit.deadline = std::chrono::steady_clock::now() +
+                         std::chrono::duration_cast<std::chrono::steady_clock::duration>(due);
+    }
+    return limit;
+}
+
+void SnazeManager::start_replay() {
+    if (m_settings.replay_dir.empty()) {
+        return;
     }
+    ReplayHeader header;
+    header.seed = m_game_seed;
+    header.lives = static_cast<uint32_t>(m_settings.lives);
+    header.food_amount = static_cast<uint32_t>(m_settings.food_amount);
+    header.bot_mode = static_cast<uint8_t>((m_snaze_mode == SnazeMode::Bot) ? m_bot_strategy
+                                                                            : BotMode::Undefined);
+    std::filesystem::create_directories(m_settings.replay_dir);
+    auto filename = std::filesystem::path(m_settings.replay_dir) /
+                    (std::to_string(m_game_seed) + REPLAY_EXTENSION);
+    m_replay.emplace(filename.string(), m_level_file, header);
+}
+
+void SnazeManager::finish_replay(bool won) {
+    if (not m_replay.has_value()) {
+        return;
+    }
+    auto outcome = won ? GameOutcome::Won : GameOutcome::Lost;
+    m_replay->finish(static_cast<uint8_t>(outcome), m_eaten_food_amount_snake,
+                     m_settings.lives - m_remaining_snake_lives);
+    m_replay.reset();
 }
 
 //
@@ -183,20 +232,16 @@ std::string SnazeManager::game_loop_info() const {
         header_oss << " " << skull;
     }
     header_oss << " | Score: 0 | Food eaten " << m_eaten_food_amount_snake << " of "
-               << m_settings.food_amount << std::endl << line(line_length) << std::endl;
+               << m_settings.food_amount;
+    if (m_scheduler.overruns() > 0) {
+        header_oss << " | Late ticks " << m_scheduler.overruns();
+    }
+    header_oss << std::endl << line(line_length) << std::endl;
     auto header_str = header_oss.str();
     padding_oss << std::setw((int)header_str.size()) << std::setfill('-');
     return header_str;
 }
 
-std::string SnazeManager::game_loop_mc() const {
-    std::ostringstream oss;
-    oss << game_loop_info() << '\n';
-    oss << m_maze.str_in_game(m_snake.body, m_snake.head_direction);
-
-    return oss.str();
-}
-
 std::string SnazeManager::controls_im() const {
     std::ostringstream oss;
     oss << "Press the following keys to play: " << std::endl
@@ -208,31 +253,7 @@ std::string SnazeManager::controls_im() const {
     return oss.str();
 }
 
-Position SnazeManager::update_snake_position() {
-    switch (m_snake.head_direction) {
-    case Direction::Up:
-        m_snake.body.emplace_front(m_snake.body[0].coord_x,
-                                   (m_snake.body[0].coord_y - 1 % m_maze.height()) %
-                                       m_maze.height());
-        break;
-    case Direction::Down:
-        m_snake.body.emplace_front(m_snake.body[0].coord_x,
-                                   (m_snake.body[0].coord_y + 1 % m_maze.height()) %
-                                       m_maze.height());
-        break;
-    case Direction::Left:
-        m_snake.body.emplace_front((m_snake.body[0].coord_x - 1 % m_maze.width()) % m_maze.width(),
-                                   m_snake.body[0].coord_y);
-        break;
-    case Direction::Right:
-        m_snake.body.emplace_front((m_snake.body[0].coord_x + 1 % m_maze.width()) % m_maze.width(),
-                                   m_snake.body[0].coord_y);
-        break;
-    }
-    return m_snake.body.front();
-}
-
-std::vector<std::string> get_files_from_directory(const std::string &dir_name) {
+std::vector<std::string> snaze::get_files_from_directory(const std::string &dir_name) {
     namespace fs = std::filesystem;
     fs::path dir_path = dir_name;
     std::vector<std::string> file_list;
@@ -244,15 +265,26 @@ std::vector<std::string> get_files_from_directory(const std::string &dir_name) {
             file_list.emplace_back(entry.path().string());
         }
     }
-    return file_list;
+    // Sorted by file, so the levels of a pack stay in their order
+    std::sort(file_list.begin(), file_list.end());
+    std::vector<std::string> level_list;
+    for (const auto &file : file_list) {
+        auto refs = LevelPack::level_refs(file);
+        level_list.insert(level_list.end(), refs.begin(), refs.end());
+    }
+    return level_list;
 }
 
-bool SnazeManager::still_levels_available() { return m_game_levels_files.size() != 0; }
-
 SnazeManager::SnazeManager(const std::string &game_levels_directory,
                            const std::string &ini_config_file_path) {
-    m_game_levels_files = get_files_from_directory(game_levels_directory);
     m_settings = ini::Parser::file(ini_config_file_path);
+    if (m_settings.seed == 0) {
+        m_settings.seed = Rng::random_seed();
+    }
+    // The first level loads while the menus are up, its draws are kept apart from the game ones
+    m_levels.assign(get_files_from_directory(game_levels_directory),
+                    m_settings.distance_budget_kb << 10, ~m_settings.seed);
+    m_scheduler.rate(m_settings.fps);
 }
 
 void SnazeManager::change_state_by_selected_menu_option() {
@@ -0,0 +1,107 @@
+#include "game_snapshot.hpp"
+
+#include <stdexcept>
+#include <vector>
+
+namespace {
+/// Packs `code` as the move `count` of `packed`, 4 to a byte from the low bits up
+void pack_move(std::vector<uint8_t> &packed, size_t count, uint8_t code) {
+    if (count % 4 == 0) {
+        packed.push_back(0);
+    }
+    packed.back() |= static_cast<uint8_t>(code << (2 * (count % 4)));
+}
+
+/// Returns the move `count` packed by `pack_move`
+uint8_t unpack_move(const std::vector<uint8_t> &packed, size_t count) {
+    return (packed[count / 4] >> (2 * (count % 4))) & 3U;
+}
+} // namespace
+
+namespace snaze {
+void GameSnapshot::write(std::ostream &os, const Maze &maze) const {
+    SnapshotHeader header;
+    header.rng = rng.state();
+    header.bot_rng = bot_rng.state();
+    header.ticks = ticks;
+    header.food_eaten = static_cast<uint32_t>(food_eaten);
+    header.lives_lost = static_cast<uint32_t>(lives_lost);
+    if (food.has_value()) {
+        header.food = static_cast<uint32_t>(maze.index(food.value()));
+    }
+    header.body = static_cast<uint32_t>(body.size());
+    header.plan = static_cast<uint32_t>(plan.size());
+    header.head_direction = static_cast<uint8_t>(head_direction);
+    if (not body.empty()) {
+        header.head_x = static_cast<uint32_t>(body.front().coord_x);
+        header.head_y = static_cast<uint32_t>(body.front().coord_y);
+    }
+
+    std::vector<uint8_t> packed;
+    packed.reserve((body.size() + plan.size()) / 4 + 2);
+    size_t count = 0;
+    for (size_t part = 1; part < body.size(); ++part) {
+        auto code = MOVES.size();
+        for (size_t dir = 0; dir < MOVES.size(); ++dir) {
+            if (maze.step(body[part - 1], MOVES[dir]) == body[part]) {
+                code = dir;
+                break;
+            }
+        }
+        if (code == MOVES.size()) {
+            throw std::invalid_argument("The snake body isn't connected");
+        }
+        pack_move(packed, count++, static_cast<uint8_t>(code));
+    }
+    for (const auto &move : plan) {
+        pack_move(packed, count++, move_code(move));
+    }
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os.write(reinterpret_cast<const char *>(packed.data()),
+             static_cast<std::streamsize>(packed.size()));
+}
+
+GameSnapshot GameSnapshot::read(std::istream &is, const Maze &maze) {
+    SnapshotHeader header;
+    if (not is.read(reinterpret_cast<char *>(&header), sizeof(header)) or
+        header.magic != SNAPSHOT_MAGIC or header.version != SNAPSHOT_VERSION) {
+        throw std::invalid_argument("Not a game snapshot");
+    }
+    const auto cells = maze.width() * maze.height();
+    const auto head_direction = static_cast<Direction>(header.head_direction);
+    if ((header.food != SNAPSHOT_NO_FOOD and header.food >= cells) or
+        (header.body > 0 and not maze.in_bound(Position(header.head_x, header.head_y))) or
+        (head_direction != Direction::None and opposite(head_direction) == Direction::None)) {
+        throw std::invalid_argument("Corrupted game snapshot");
+    }
+    const size_t moves = (header.body > 0 ? header.body - 1 : 0) + size_t{header.plan};
+    std::vector<uint8_t> packed((moves + 3) / 4);
+    if (not is.read(reinterpret_cast<char *>(packed.data()),
+                    static_cast<std::streamsize>(packed.size()))) {
+        throw std::invalid_argument("Corrupted game snapshot");
+    }
+
+    GameSnapshot snapshot;
+    snapshot.rng.state(header.rng);
+    snapshot.bot_rng.state(header.bot_rng);
+    snapshot.ticks = header.ticks;
+    snapshot.food_eaten = header.food_eaten;
+    snapshot.lives_lost = header.lives_lost;
+    if (header.food != SNAPSHOT_NO_FOOD) {
+        snapshot.food = Position(header.food % maze.width(), header.food / maze.width());
+    }
+    snapshot.head_direction = head_direction;
+    size_t count = 0;
+    if (header.body > 0) {
+        snapshot.body.emplace_back(header.head_x, header.head_y);
+        for (size_t part = 1; part < header.body; ++part) {
+            snapshot.body.push_back(
+                maze.step(snapshot.body.back(), code_move(unpack_move(packed, count++))));
+        }
+    }
+    for (size_t move = 0; move < header.plan; ++move) {
+        snapshot.plan.push_back(code_move(unpack_move(packed, count++)));
+    }
+    return snapshot;
+}
+} // namespace snaze
@@ -0,0 +1,242 @@
+#include "grid_search.hpp"
+#include "maze.hpp"
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <deque>
+#include <vector>
+
+namespace {
+constexpr std::array directions{snaze::Direction::Up, snaze::Direction::Down,
+                                snaze::Direction::Left, snaze::Direction::Right};
+} // namespace
+
+namespace snaze {
+bool GridSearch::breadth_first(const Maze &maze, const std::deque<Position> &body,
+                               const Direction &head_direction, std::vector<Direction> &path,
+                               const SearchLimit &limit) {
+    start_search(maze, body);
+    const auto start = static_cast<Index>(maze.index(body.front()));
+    const auto food = static_cast<Index>(maze.index(maze.food()));
+    if (not reachable(maze, start, food)) {
+        path.clear();
+        return false;
+    }
+    if (not expand_breadth_first(maze, start, head_direction, food, limit)) {
+        if (m_interrupted) {
+            return interrupt(path);
+        }
+        path.clear();
+        return false;
+    }
+    reconstruct_path(start, food, path);
+    return true;
+}
+
+GridSearch::Room GridSearch::flood_fill(const Maze &maze, const std::deque<Position> &body) {
+    start_search(maze, body);
+    const auto start = static_cast<Index>(maze.index(body.front()));
+    const auto tail = static_cast<Index>(maze.index(body.back()));
+    expand_breadth_first(maze, start, Direction::None, NO_CELL);
+    return {m_expanded - 1, body.size() > 1 and m_visited[tail] == m_generation};
+}
+
+bool GridSearch::path_to(const Maze &maze, const Position &target,
+                         std::vector<Direction> &path) const {
+    path.clear();
+    if (m_start == NO_CELL or not maze.in_bound(target)) {
+        return false;
+    }
+    auto cell = static_cast<Index>(maze.index(target));
+    if (cell >= m_visited.size() or m_visited[cell] != m_generation) {
+        return false;
+    }
+    reconstruct_path(m_start, cell, path);
+    return true;
+}
+
+bool GridSearch::expand_breadth_first(const Maze &maze, Index start,
+                                      const Direction &head_direction, Index target,
+                                      const SearchLimit &limit) {
+    const bool bounded = limit.bounded() and target != NO_CELL;
+    const auto width = maze.width();
+    const auto target_pos = bounded ? Position(target % width, target / width) : Position();
+    size_t queue_head = 0;
+    size_t queue_tail = 0;
+    m_visited[start] = m_generation;
+    m_depth[start] = 0;
+    m_queue[queue_tail++] = start;
+    while (queue_head < queue_tail) {
+        auto current = m_queue[queue_head++];
+        ++m_expanded;
+        if (current == target) {
+            return true;
+        }
+        if (bounded and
+            not keep_going(current,
+                           static_cast<uint32_t>(maze.torus_distance(
+                               Position(current % width, current / width), target_pos)),
+                           limit)) {
+            return false;
+        }
+        auto next_depth = m_depth[current] + 1;
+        for (const auto &dir : directions) {
+            // Only the real head can't turn back, deeper nodes can't reach their parent anyway
+            if (current == start and dir == opposite(head_direction)) {
+                continue;
+            }
+            auto next = static_cast<Index>(maze.step(current, dir));
+            if (maze.is_wall(next) or m_visited[next] == m_generation or
+                occupied(next, next_depth)) {
+                continue;
+            }
+            m_visited[next] = m_generation;
+            m_depth[next] = next_depth;
+            m_parent[next] = current;
+            m_came_from[next] = dir;
+            m_queue[queue_tail++] = next;
+        }
+    }
+    return false;
+}
+
+bool GridSearch::a_star(const Maze &maze, const std::deque<Position> &body,
+                        const Direction &head_direction, std::vector<Direction> &path,
+                        const SearchLimit &limit) {
+    start_search(maze, body);
+    const auto start = static_cast<Index>(maze.index(body.front()));
+    const auto food_pos = maze.food();
+    const auto food = static_cast<Index>(maze.index(food_pos));
+    const auto width = maze.width();
+    const auto *distances = maze.distances();
+    auto estimate = [&](Index cell) {
+        auto bound = static_cast<uint32_t>(
+            maze.torus_distance(Position(cell % width, cell / width), food_pos));
+        return (distances == nullptr) ? bound : std::max(bound, distances->lower_bound(cell, food));
+    };
+    if (not reachable(maze, start, food)) {
+        path.clear();
+        return false;
+    }
+    m_open.clear();
+    // Only A* needs the heap, flood fills and breadth-first searches never grow it. Every cell
+    // can be pushed once per neighbour, plus the start.
+    m_open.reserve(4 * maze.width() * maze.height() + 1);
+    m_visited[start] = m_generation;
+    m_depth[start] = 0;
+    m_open.push_back({estimate(start), estimate(start), start});
+    const bool bounded = limit.bounded();
+    while (not m_open.empty()) {
+        std::pop_heap(m_open.begin(), m_open.end());
+        auto current = m_open.back().cell;
+        auto current_estimate = m_open.back().estimate;
+        m_open.pop_back();
+        if (m_closed[current] == m_generation) {
+            continue; // Stale entry, the cell was reached again through a shorter path
+        }
+        m_closed[current] = m_generation;
+        ++m_expanded;
+        if (current == food) {
+            reconstruct_path(start, current, path);
+            return true;
+        }
+        if (bounded and not keep_going(current, current_estimate, limit)) {
+            return interrupt(path);
+        }
+        auto next_depth = m_depth[current] + 1;
+        for (const auto &dir : directions) {
+            if (current == start and dir == opposite(head_direction)) {
+                continue;
+            }
+            auto next = static_cast<Index>(maze.step(current, dir));
+            if (maze.is_wall(next) or m_closed[next] == m_generation or
+                (m_visited[next] == m_generation and m_depth[next] <= next_depth) or
+                occupied(next, next_depth)) {
+                continue;
+            }
+            m_visited[next] = m_generation;
+            m_depth[next] = next_depth;
+            m_parent[next] = current;
+            m_came_from[next] = dir;
+            auto next_estimate = estimate(next);
+            m_open.push_back({next_depth + next_estimate, next_estimate, next});
+            std::push_heap(m_open.begin(), m_open.end());
+        }
+    }
+    path.clear();
+    return false;
+}
+
+bool GridSearch::keep_going(Index cell, uint32_t estimate, const SearchLimit &limit) {
+    if (m_best == NO_CELL or estimate < m_best_estimate) {
+        m_best = cell;
+        m_best_estimate = estimate;
+    }
+    if ((limit.expanded > 0 and m_expanded >= limit.expanded) or
+        (limit.deadline.has_value() and m_expanded % CLOCK_INTERVAL == 0 and
+         std::chrono::steady_clock::now() >= limit.deadline.value())) {
+        m_interrupted = true;
+        return false;
+    }
+    return true;
+}
+
+bool GridSearch::interrupt(std::vector<Direction> &path) const {
+    if (m_best == NO_CELL) {
+        path.clear();
+    } else {
+        reconstruct_path(m_start, m_best, path);
+    }
+    return false;
+}
+
+void GridSearch::fit(const Maze &maze) {
+    auto cells = maze.width() * maze.height();
+    if (cells <= m_visited.size()) {
+        return;
+    }
+    m_visited.resize(cells, 0);
+    m_closed.resize(cells, 0);
+    m_body_stamp.resize(cells, 0);
+    m_vacate.resize(cells);
+    m_depth.resize(cells);
+    m_parent.resize(cells);
+    m_came_from.resize(cells, Direction::None);
+    m_queue.resize(cells);
+}
+
+void GridSearch::start_search(const Maze &maze, const std::deque<Position> &body) {
+    fit(maze);
+    if (++m_generation == 0) {
+        std::fill(m_visited.begin(), m_visited.end(), 0);
+        std::fill(m_closed.begin(), m_closed.end(), 0);
+        std::fill(m_body_stamp.begin(), m_body_stamp.end(), 0);
+        m_generation = 1;
+    }
+    m_expanded = 0;
+    m_best = NO_CELL;
+    m_interrupted = false;
+    m_start = static_cast<Index>(maze.index(body.front()));
+    // The game moves the head before dropping the tail, so the body part `rank` moves away from
+    // the head (the tail included) still covers its cell when the head arrives there on move
+    // `body.size() - rank`. Walking the body backwards, so the latest tick remains when the body
+    // overlaps itself.
+    for (size_t rank = body.size(); rank-- > 0;) {
+        if (not maze.in_bound(body[rank])) {
+            continue;
+        }
+        auto cell = maze.index(body[rank]);
+        m_body_stamp[cell] = m_generation;
+        m_vacate[cell] = static_cast<uint32_t>(body.size() - rank);
+    }
+}
+
+void GridSearch::reconstruct_path(Index start, Index end, std::vector<Direction> &path) const {
+    path.clear();
+    for (auto current = end; current != start; current = m_parent[current]) {
+        path.push_back(m_came_from[current]);
+    }
+    std::reverse(path.begin(), path.end());
+}
+} // namespace snaze
@@ -0,0 +1,51 @@
+#ifndef BATCH_RUNNER_HPP
+#define BATCH_RUNNER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "simulation.hpp"
+#include "snake.hpp"
+
+namespace snaze {
+/// Aggregated results of the games played by a bot in a level
+struct LevelSummary {
+    std::string level;                    //!< Level file that was played
+    BotMode bot_mode{BotMode::Undefined}; //!< Bot that played it
+    size_t games{0};                      //!< Games played
+    size_t won{0};                        //!< Games won
+    size_t lost{0};                       //!< Games lost
+    size_t stalled{0};                    //!< Games that hit the tick limit
+    size_t food_eaten{0};                 //!< Food eaten over all games
+    size_t lives_lost{0};                 //!< Lives lost over all games
+    size_t ticks{0};                      //!< Ticks played over all games
+    double wall_ms{0};                    //!< Sum of the games wall-clock time
+    size_t searches{0};                   //!< Bot searches over all games
+    size_t nodes_expanded{0};             //!< Cells expanded by the bot searches over all games
+    size_t distance_kb{0};                //!< Memory taken by the level distance field
+    double distance_ms{0};                //!< Time took to build the level distance field
+
+    /// Accounts the result of one more game
+    void add(const GameResult &result);
+};
+
+/// Results of a whole batch run
+struct BatchReport {
+    std::vector<LevelSummary> summaries; //!< One per level and bot, in the options order
+    size_t threads{0};                   //!< Worker threads used
+    double wall_ms{0};                   //!< Wall-clock time took by the whole batch
+    uint64_t seed{0};                    //!< Seed of the first game
+};
+
+/// Plays `games_per_level` games of every bot in every level of `options`, spreading the levels
+/// over a work-stealing thread pool, each loaded by the worker playing it and dropped once its
+/// games are done. Games are seeded as in `run_headless`, so both play the same games.
+BatchReport run_batch(const HeadlessOptions &options);
+
+/// Writes the level summaries of `report` as CSV in `os`
+void write_report(const BatchReport &report, std::ostream &os);
+} // namespace snaze
+#endif // !BATCH_RUNNER_HPP
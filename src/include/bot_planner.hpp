@@ -0,0 +1,80 @@
+#ifndef BOT_PLANNER_HPP
+#define BOT_PLANNER_HPP
+
+#include <chrono>
+#include <deque>
+#include <future>
+
+#include "maze.hpp"
+#include "grid_search.hpp"
+#include "rng.hpp"
+#include "snake.hpp"
+
+namespace snaze {
+/**
+ * @brief Makes the bot plans on a worker thread, one plan ahead of the snake.
+ *
+ * A plan is asked for the state the snake will be in once it made the moves it has left: the
+ * worker makes those moves on its own copy of the game, drawing the food the game will draw,
+ * and the bot thinks from there. So the next plan is made while the snake follows the current
+ * one, and is usually ready by the time it runs out.
+ *
+ * When it isn't, `take` waits for it up to a budget and hands over a `SnakeBot::fallback_move`
+ * instead. The plan being made is then stale, it's thrown away once done, and the next one is
+ * asked for the state after the fallback move, as after any plan, so the planner catches up
+ * with the snake. Every request is bounded by the time the plan will be needed, and a bot out of
+ * time plans the best path it found so far instead of making the snake wait for it.
+ */
+class BotPlanner {
+  public:
+    /// A plan handed over by `take`
+    struct Plan {
+        std::deque<Direction> moves; //!< Moves to make, never empty
+        Rng bot_rng;                 //!< The bot generator once the plan was made
+        bool fallback{false};        //!< Tells if no plan was ready, the move being a fallback
+    };
+
+    /// Planner with nothing to plan for
+    BotPlanner() = default;
+    /// Waits for the plan being made, if any
+    ~BotPlanner();
+    BotPlanner(const BotPlanner &) = delete;
+    BotPlanner &operator=(const BotPlanner &) = delete;
+    BotPlanner(BotPlanner &&) = delete;
+    BotPlanner &operator=(BotPlanner &&) = delete;
+
+    /// Plans for a life in `maze` played by the bot `mode` from now on, waiting for the plan
+    /// being made and dropping it
+    void reset(const Maze &maze, BotMode mode);
+    /// Starts making the plan for the state `snake` will be in after `moves`, the food of
+    /// `maze` being drawn with `rng` as the game will and the bot drawing with `bot_rng`, its
+    /// search bounded by `limit`. Does nothing while another plan is being made.
+    void request(const Maze &maze, const Snake &snake, const std::deque<Direction> &moves,
+                 const Rng &rng, const Rng &bot_rng, const SearchLimit &limit = {});
+    /// Hands over the plan for the current state of `snake` in `maze`, asking for it first when
+    /// nothing is being planned, due within half `budget`, and waiting for it at most `budget`
+    /// (zero waits however long it takes). When it isn't ready in time, or it was made for a
+    /// state the game didn't reach, a single `SnakeBot::fallback_move` is handed over instead,
+    /// with `bot_rng` as it was. The next plan is to be asked for after its moves either way.
+    Plan take(const Maze &maze, const Snake &snake, const Rng &rng, const Rng &bot_rng,
+              std::chrono::duration<double, std::milli> budget);
+
+  private:
+    /// A plan made by the worker, with the state it was made for
+    struct Result {
+        std::deque<Position> body; //!< The snake body the plan starts from
+        Position food;             //!< Where the food was then
+        Plan plan;                 //!< The plan
+    };
+
+    Maze m_maze;                   //!< The worker copy of the maze, sharing the level
+    Snake m_snake;                 //!< The worker copy of the snake
+    SnakeBot m_bot;                //!< The bot, only run by the worker
+    std::future<Result> m_pending; //!< Plan being made
+
+    /// Makes the plan of a `request`, run by the worker
+    Result plan(Position food, std::deque<Position> body, Direction direction,
+                std::deque<Direction> moves, Rng rng, Rng bot_rng, SearchLimit limit);
+};
+} // namespace snaze
+#endif // !BOT_PLANNER_HPP
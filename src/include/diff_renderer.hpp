@@ -0,0 +1,39 @@
+#ifndef DIFF_RENDERER_HPP
+#define DIFF_RENDERER_HPP
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "maze.hpp"
+#include "snake.hpp"
+
+namespace snaze {
+/// Renders the in game screen (a header followed by the maze with the snake) by keeping the
+/// cells of the previous frame and only emitting the cells that changed, each one behind a
+/// cursor positioning escape sequence. So a frame costs about as much as the snake moved,
+/// instead of the whole maze area. A header that takes another number of rows moves the whole
+/// maze, so the frame is drawn in full then.
+class DiffRenderer {
+  public:
+    /// Forgets the previous frame, so the next one is drawn from scratch
+    void invalidate() { m_valid = false; }
+    /// Returns what must be written to the terminal to turn the previous frame into the one
+    /// showing `header` followed by `maze` with `snake` over it
+    std::string frame(const std::string &header, const Maze &maze, const Snake &snake);
+
+  private:
+    std::vector<Maze::Cell> m_previous;                   //!< Cells shown by the previous frame
+    std::vector<Maze::Cell> m_current;                    //!< Cells of the frame being drawn
+    std::string m_previous_header;                        //!< Header shown by the previous frame
+    size_t m_header_rows{0};                              //!< Rows of the previous header
+    Direction m_previous_head_direction{Direction::None}; //!< Head direction of previous frame
+    size_t m_width{0};                                    //!< Maze width of the previous frame
+    bool m_valid{false}; //!< Tells if the terminal still shows the previous frame
+
+    /// Draws the whole frame after clearing the screen
+    std::string full_frame(const std::string &header, const Maze &maze,
+                           const Direction &head_direction) const;
+};
+} // namespace snaze
+#endif // !DIFF_RENDERER_HPP
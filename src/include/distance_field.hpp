@@ -0,0 +1,69 @@
+#ifndef DISTANCE_FIELD_HPP
+#define DISTANCE_FIELD_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace snaze {
+class Maze;
+
+/// Move distances between the cells of a level counting only the walls (and the border
+/// wraparound), computed once when the level is loaded. The snake body only makes paths longer,
+/// so these are lower bounds of the real path lengths, fit for an A* heuristic.
+///
+/// When the distances between every pair of free cells fit the memory budget they're all kept,
+/// and the bound is exact. Otherwise only the distances from a few far apart landmark cells
+/// are, and the bound comes from the triangle inequality. Either way the connected component
+/// of every cell is kept, so telling if a cell can be reached at all is a single comparison.
+class DistanceField {
+  public:
+    using Distance = uint16_t;
+    static constexpr Distance UNREACHABLE = UINT16_MAX; //!< Distance between two components
+    static constexpr Distance FARTHEST = UINT16_MAX - 1; //!< Longer distances are clamped to it
+    static constexpr size_t MAX_LANDMARKS = 16;          //!< Landmarks kept at most
+
+    /// Builds the field of `maze` spending at most `budget_bytes` on it. With a budget too small
+    /// for even the components the field is left empty, see `empty`.
+    DistanceField(const Maze &maze, size_t budget_bytes);
+
+    /// Tells if nothing was built
+    [[nodiscard]] bool empty() const { return m_component.empty(); }
+    /// Tells if every pair of free cells has its exact distance kept
+    [[nodiscard]] bool exact() const { return m_exact; }
+    /// How many landmarks are kept, when not exact
+    [[nodiscard]] size_t landmarks() const { return m_landmarks.size(); }
+    /// Bytes taken by the field
+    [[nodiscard]] size_t memory_bytes() const;
+    /// Milliseconds taken to build the field
+    [[nodiscard]] double build_ms() const { return m_build_ms; }
+
+    /// Tells if the cell `to` can be reached from the cell `from` at all, walls aside of the
+    /// snake body
+    [[nodiscard]] bool reachable(size_t from, size_t to) const {
+        return m_component[from] != NO_COMPONENT and m_component[from] == m_component[to];
+    }
+    /// Returns a lower bound of the moves from the cell `from` to the cell `to`, exact when the
+    /// field is and both cells are no farther than `FARTHEST`
+    [[nodiscard]] uint32_t lower_bound(size_t from, size_t to) const;
+
+  private:
+    static constexpr uint32_t NO_COMPONENT = UINT32_MAX; //!< Component of the walls
+
+    std::vector<uint32_t> m_component; //!< Connected component of each cell
+    std::vector<uint32_t> m_slot;      //!< Row of each free cell in `m_distances`, when exact
+    std::vector<uint32_t> m_landmarks; //!< Landmark cells, when not exact
+    std::vector<Distance> m_distances; //!< Free cells by free cells, or landmarks by cells
+    size_t m_cells{0};                 //!< Cells of the maze
+    size_t m_free{0};                  //!< Free cells of the maze
+    bool m_exact{false};               //!< Tells if all the pairs were kept
+    double m_build_ms{0};              //!< Build time
+
+    /// Labels the connected components of `maze`, counting the free cells
+    void label_components(const Maze &maze, std::vector<uint32_t> &queue);
+    /// Writes in `out`, indexed by cell or by slot, the distance from `source` to every cell
+    void breadth_first(const Maze &maze, uint32_t source, Distance *out, bool by_slot,
+                       std::vector<uint32_t> &queue) const;
+};
+} // namespace snaze
+#endif // !DISTANCE_FIELD_HPP
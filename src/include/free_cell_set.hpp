@@ -0,0 +1,102 @@
+#ifndef FREE_CELL_SET_HPP
+#define FREE_CELL_SET_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "maze.hpp"
+
+namespace snaze {
+/**
+ * @brief Set of the maze cells food may go to, with logarithmic insert, erase and sampling.
+ *
+ * Members are ranked in row-major order, with a Fenwick tree counting them over the maze cells,
+ * so the member of a rank is found in a walk down the tree. Which member a rank gives only
+ * depends on which cells are in the set, not on the order they were taken in. Cells that aren't
+ * food cells of the maze are never taken in.
+ */
+class FreeCellSet {
+  public:
+    /// Fills the set with every food cell of `maze`, see `Maze::free_cells`
+    void reset(const Maze &maze) {
+        const auto cells = maze.width() * maze.height();
+        m_state.assign(cells, NOT_FOOD_CELL);
+        m_tree.assign(cells + 1, 0);
+        for (const auto &pos : maze.free_cells()) {
+            auto cell = maze.index(pos);
+            m_state[cell] = IN;
+            m_tree[cell + 1] = 1;
+        }
+        // Builds the tree in place in linear time, every node adding itself to its parent
+        for (size_t node = 1; node <= cells; ++node) {
+            auto parent = node + (node & (~node + 1));
+            if (parent <= cells) {
+                m_tree[parent] += m_tree[node];
+            }
+        }
+        m_size = maze.free_cells().size();
+        m_top = 1;
+        while (m_top * 2 <= cells) {
+            m_top *= 2;
+        }
+    }
+    /// Adds `cell` back, if it's a food cell not in the set already
+    void insert(size_t cell) {
+        if (cell >= m_state.size() or m_state[cell] != OUT) {
+            return;
+        }
+        m_state[cell] = IN;
+        ++m_size;
+        add(cell, +1);
+    }
+    /// Takes `cell` out, if it's in the set
+    void erase(size_t cell) {
+        if (not contains(cell)) {
+            return;
+        }
+        m_state[cell] = OUT;
+        --m_size;
+        add(cell, -1);
+    }
+    /// Tells if `cell` is in the set
+    [[nodiscard]] bool contains(size_t cell) const {
+        return cell < m_state.size() and m_state[cell] == IN;
+    }
+    /// Returns how many cells are in the set
+    [[nodiscard]] size_t size() const { return m_size; }
+    /// Tells if the set is empty
+    [[nodiscard]] bool empty() const { return m_size == 0; }
+    /// Returns the member of row-major `rank`, which is below `size()`. A uniform rank gives a
+    /// uniform member.
+    [[nodiscard]] size_t at(size_t rank) const {
+        // Finds the last node whose prefix holds `rank` members at most, the member is next
+        size_t node = 0;
+        for (auto step = m_top; step > 0; step /= 2) {
+            if (node + step < m_tree.size() and m_tree[node + step] <= rank) {
+                node += step;
+                rank -= m_tree[node];
+            }
+        }
+        return node;
+    }
+
+  private:
+    static constexpr uint8_t NOT_FOOD_CELL = 0; //!< State of cells never in the set
+    static constexpr uint8_t OUT = 1;           //!< State of food cells taken out
+    static constexpr uint8_t IN = 2;            //!< State of the members
+
+    std::vector<uint8_t> m_state; //!< State of each maze cell, one of the markers above
+    std::vector<uint32_t> m_tree; //!< Fenwick tree of the members, node `cell + 1` for `cell`
+    size_t m_size{0};             //!< Members in the set
+    size_t m_top{1};              //!< Highest power of two up to the maze cells, where `at` starts
+
+    /// Adds `delta` members at `cell` in the tree
+    void add(size_t cell, int delta) {
+        for (auto node = cell + 1; node < m_tree.size(); node += node & (~node + 1)) {
+            m_tree[node] += static_cast<uint32_t>(delta);
+        }
+    }
+};
+} // namespace snaze
+#endif // !FREE_CELL_SET_HPP
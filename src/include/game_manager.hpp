@@ -1,8 +1,16 @@
 #ifndef GAME_MANAGER_HPP
 #define GAME_MANAGER_HPP
 
+#include "bot_planner.hpp"
+#include "diff_renderer.hpp"
+#include "frame_scheduler.hpp"
+#include "level_prefetcher.hpp"
 #include "maze.hpp"
+#include "replay.hpp"
 #include "snake.hpp"
+#include "terminal_utils.h"
+#include <deque>
+#include <optional>
 #include <stack>
 #include <string>
 #include <vector>
@@ -11,12 +19,20 @@ namespace snaze {
 
 /// Snaze runnings opts that are cone be read from a ini file
 struct Settings {
-    size_t fps;
+    double fps;
     size_t lives;
     size_t food_amount;
     std::string player_type;
+    size_t distance_budget_kb{Maze::DEFAULT_DISTANCE_BUDGET >> 10}; //!< See `Maze::distances`
+    uint64_t seed{0}; //!< Seed of the food, level and random bot draws, zero picks one at random
+    std::string replay_dir; //!< Where every game is recorded as `<seed>.snzr`, empty for nowhere
+    double think_budget_ms{0}; //!< How long a bot tick waits for its plan, zero for as needed
 };
 
+/// Returns a level for every regular file inside `dir_name`, sorted by file: its path, or a
+/// `level_ref` per level when the file is a pack of them (see `LevelPack::level_refs`)
+std::vector<std::string> get_files_from_directory(const std::string &dir_name);
+
 /// Class keeps track of the Snaze as whole, and follows GameLoop design
 /// pattern: https://gameprogrammingpatterns.com/game-loop.html
 class SnazeManager {
@@ -46,13 +62,6 @@ class SnazeManager {
         Bot,
         Undefined,
     };
-    /// Enum that represents algorithm that will be used to solve the maze
-    enum class BotMode {
-        Smart = 1,
-        Dumb,
-        // Backtracking??
-        Undefined,
-    };
 
     // Header info
     size_t m_score;
@@ -64,12 +73,21 @@ class SnazeManager {
     size_t m_eaten_food_amount_snake{0};        //!< How much food the snake have already eaten
     bool m_game_over{false};                    //!< Boolean to tell if the game as ended or not
     bool m_new_game{true};
-    SnakeBot m_snake_bot;                         //!< A bot that autoplays the game
-    Snake m_snake;                                //!< The actual snake that are being moved
-    Maze m_maze;                                  //!< Representation of the maze
-    std::vector<std::string> m_game_levels_files; //!<- A list containing all the game levels
+    BotPlanner m_planner;                 //!< Makes the bot plans on a worker thread
+    std::deque<Direction> m_bot_moves;    //!< Moves of the bot plan left to make
+    Snake m_snake;                        //!< The actual snake that are being moved
+    Maze m_maze;                          //!< Representation of the maze
+    std::string m_level_file;             //!< File or `level_ref` of `m_maze`
+    LevelPrefetcher m_levels;             //!< Loads the next game level in the background
+    uint64_t m_games{0};                  //!< Games started, the game `n` is seeded `seed + n`
+    uint64_t m_game_seed{0};              //!< Seed of the current game
+    Rng m_rng;                            //!< Draws the food, seeded `m_game_seed`
+    Rng m_bot_rng;                        //!< Draws the random bot moves, seeded `~m_game_seed`
+    std::optional<ReplayWriter> m_replay; //!< Records the current game, see `Settings::replay_dir`
 
     // Render related variables and methods
+    DiffRenderer m_renderer;    //!< Draws the On screen redrawing only what changed
+    FrameScheduler m_scheduler; //!< Keeps the On ticks at `m_settings.fps`
     std::string m_screen_title;
     std::string m_main_content;
     std::string m_system_msg;
@@ -109,8 +127,6 @@ class SnazeManager {
     [[nodiscard]] std::string controls_im() const;
     /// It renders the remaining lives and pontuation of the player
     [[nodiscard]] std::string game_loop_info() const;
-    /// It renders the snake with the maze
-    [[nodiscard]] std::string game_loop_mc() const;
 
     // Process related variables and methods
     SnazeMode m_snaze_mode{SnazeMode::Undefined}; //!< How the snaze will be played
@@ -118,6 +134,7 @@ class SnazeManager {
     MainMenuOption m_menu_option{
         MainMenuOption::Undefined}; //!< The selected menu option in Main menu state
     bool m_asked_to_quit{false};
+    RawInput m_input; //!< Raw mode session that queues the keys pressed while the game is on
     /// Reads the user main menu selected option
     MainMenuOption read_menu_option();
     /// Reads the user SnazeModeselected option
@@ -128,14 +145,20 @@ class SnazeManager {
     [[nodiscard]] static Direction read_starting_direction();
     /// Reads the game input
     [[nodiscard]] static Direction input(char keystroke, Direction previous_direction);
-    /// Update snake position based on her head direction, returns the new position of the snake
-    Position update_snake_position();
     // Update related variables and methods
     void change_state_by_selected_menu_option();
-    /// Verify if all the levels were played
-    [[nodiscard]] bool still_levels_available();
-    /// Calls the bot for thinking, can throw a exception when there's no solution
-    void snake_bot_think(const Snake &snake);
+    /// Returns the next bot move, taking the next plan when the current one is over and asking
+    /// for the one after it. Makes `SnakeBot::fallback_move` when the plan isn't ready within
+    /// `Settings::think_budget_ms`. Can throw a exception when the bot has no move at all.
+    [[nodiscard]] Direction next_bot_move();
+    /// Returns the bound of the plan needed once `moves` more ticks are played: due half
+    /// `Settings::think_budget_ms` after that tick, the other half being left to hand it over.
+    /// There's no bound when there's no budget or the ticks aren't paced.
+    [[nodiscard]] SearchLimit think_limit(size_t moves) const;
+    /// Starts recording the current game, when `Settings::replay_dir` is set
+    void start_replay();
+    /// Ends the replay of the current game, if it's recorded, as won or lost
+    void finish_replay(bool won);
 
   public:
     /// Constructor
@@ -0,0 +1,69 @@
+#ifndef GAME_SNAPSHOT_HPP
+#define GAME_SNAPSHOT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <istream>
+#include <optional>
+#include <ostream>
+
+#include "maze.hpp"
+#include "rng.hpp"
+
+namespace snaze {
+/// First bytes of every written snapshot
+constexpr std::array<char, 4> SNAPSHOT_MAGIC{'S', 'N', 'Z', 'S'};
+/// Layout version of the written snapshots
+constexpr uint32_t SNAPSHOT_VERSION = 1;
+/// `SnapshotHeader::food` of a snapshot taken before the food was placed
+constexpr uint32_t SNAPSHOT_NO_FOOD = UINT32_MAX;
+
+/// Header of a written snapshot. It's followed by the snake body, as the moves that lead from
+/// each part to the next one starting at `head`, and by the bot plan, both 2 bits per move and
+/// 4 to a byte from the low bits up, as the replay moves. Everything is in host byte order.
+struct SnapshotHeader {
+    std::array<char, 4> magic{SNAPSHOT_MAGIC}; //!< Always `SNAPSHOT_MAGIC`
+    uint32_t version{SNAPSHOT_VERSION};        //!< Layout version
+    std::array<uint64_t, 4> rng{};             //!< State of the food generator
+    std::array<uint64_t, 4> bot_rng{};         //!< State of the bot generator
+    uint64_t ticks{0};                         //!< Ticks played
+    uint32_t food_eaten{0};                    //!< Food eaten so far
+    uint32_t lives_lost{0};                    //!< Lives lost so far
+    uint32_t food{SNAPSHOT_NO_FOOD};           //!< Cell of the food
+    uint32_t head_x{0};                        //!< Column of the snake head
+    uint32_t head_y{0};                        //!< Row of the snake head
+    uint32_t body{0};                          //!< Snake parts, zero before the game starts
+    uint32_t plan{0};                          //!< Moves of the bot plan
+    uint8_t head_direction{0};                 //!< `Direction` the snake heads to
+    std::array<uint8_t, 3> reserved{};         //!< Keeps the header 8 bytes aligned
+};
+
+/**
+ * @brief The state of a game between two ticks, as far as it changes while the game is played.
+ *
+ * The level itself is left out, copies of a `Maze` share it, so a snapshot takes as much room
+ * and time as the snake body and the bot plan, whatever the size of the level. Restoring it in
+ * a game of the same level and seeds plays on exactly as the game went after it was taken.
+ */
+struct GameSnapshot {
+    std::optional<Position> food;              //!< Where the food is, once placed
+    std::deque<Position> body;                 //!< The snake body, head first
+    Direction head_direction{Direction::None}; //!< Where the snake heads to
+    std::deque<Direction> plan;                //!< Moves the bot planned and didn't make yet
+    size_t ticks{0};                           //!< Ticks played
+    size_t food_eaten{0};                      //!< Food eaten so far
+    size_t lives_lost{0};                      //!< Lives lost so far
+    Rng rng;                                   //!< Generator of the food
+    Rng bot_rng;                               //!< Generator of the random bot moves
+
+    /// Writes the snapshot in its compact form, see `SnapshotHeader`, the body being moves in
+    /// `maze`. Throws `std::invalid_argument` when the body parts aren't next to each other.
+    void write(std::ostream &os, const Maze &maze) const;
+    /// Reads a snapshot written by `write` with `maze`, throws `std::invalid_argument` when
+    /// it's not one
+    static GameSnapshot read(std::istream &is, const Maze &maze);
+};
+} // namespace snaze
+#endif // !GAME_SNAPSHOT_HPP
@@ -0,0 +1,132 @@
+#ifndef GRID_SEARCH_HPP
+#define GRID_SEARCH_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <optional>
+#include <vector>
+
+#include "maze.hpp"
+
+namespace snaze {
+/// Bounds a search, none by default
+struct SearchLimit {
+    size_t expanded{0}; //!< Cells the search may expand, zero for as many as it takes
+    std::optional<std::chrono::steady_clock::time_point> deadline; //!< When it must be over
+
+    /// Tells if the search is bounded at all
+    [[nodiscard]] bool bounded() const { return expanded > 0 or deadline.has_value(); }
+};
+
+/// Search engine that works on dense cell indices (`y * width + x`) instead of `Position` keyed
+/// containers. Its buffers are sized to the biggest maze seen so far and reused by every
+/// subsequent search, so after the first call a replan does no heap allocation. Moves wrap
+/// around the maze borders, like the snake does.
+///
+/// When the maze has a distance field, A* is guided by it too, and both searches give up right
+/// away on food out of the head's connected component.
+///
+/// Both searches look for the shortest path from the head of a snake body to the maze food.
+/// The body moves along with the head, so before each search every body cell is stamped with
+/// its vacate tick, the last move after which the tail still covers it. A cell is then free for
+/// the head if it arrives there on a later move, so no body has to be simulated along the
+/// search. On success the path is written in `path` (first move first) and `true` is returned.
+///
+/// A search may be bounded by a `SearchLimit`. When it runs out of it, it stops with `false`,
+/// `interrupted()` tells so, and `path` leads to the cell closest to the food it had expanded,
+/// which is the best it could do in the time it had.
+class GridSearch {
+  public:
+    using Index = uint32_t;
+    static constexpr Index NO_CELL = UINT32_MAX; //!< Index of no cell at all
+
+    /// Room left to the head of a snake body
+    struct Room {
+        size_t cells{0};   //!< Cells the head can reach
+        bool tail{false};  //!< Tells if the tail cell is one of them, once the tail left it
+    };
+
+    /// Breadth-first search, it expands every cell closer to the head than the food
+    bool breadth_first(const Maze &maze, const std::deque<Position> &body,
+                       const Direction &head_direction, std::vector<Direction> &path,
+                       const SearchLimit &limit = {});
+    /// A* search, guided by the Manhattan distance to the food counting the border wraparound,
+    /// which never overestimates the path length, so the path found is still a shortest one
+    bool a_star(const Maze &maze, const std::deque<Position> &body,
+                const Direction &head_direction, std::vector<Direction> &path,
+                const SearchLimit &limit = {});
+    /// Flood fills the cells the head of `body` can reach, with the same vacate rule as the
+    /// searches. A snake that can still reach its tail can follow it while there's no path to
+    /// the food.
+    Room flood_fill(const Maze &maze, const std::deque<Position> &body);
+    /// Writes in `path` the moves the last breadth-first search or flood fill has found from the
+    /// head to `target`. Returns `false` when it haven't reached `target`.
+    bool path_to(const Maze &maze, const Position &target, std::vector<Direction> &path) const;
+    /// Returns how many cells the last search has expanded
+    [[nodiscard]] size_t expanded() const { return m_expanded; }
+    /// Tells if the last search ran out of its limit before it was over
+    [[nodiscard]] bool interrupted() const { return m_interrupted; }
+
+  private:
+    /// Expansions between two reads of the clock, when the search has a deadline
+    static constexpr size_t CLOCK_INTERVAL = 256;
+
+    /// A cell waiting in the A* open list
+    struct OpenEntry {
+        uint32_t cost;      //!< Moves done plus the estimate of the moves left
+        uint32_t estimate;  //!< Estimate of the moves left, breaks the `cost` ties
+        Index cell;         //!< The cell
+        /// Heap order, the entry with the smallest cost (then estimate) is on top
+        bool operator<(const OpenEntry &rhs) const {
+            return cost > rhs.cost or (cost == rhs.cost and estimate > rhs.estimate);
+        }
+    };
+
+    std::vector<uint32_t> m_visited;     //!< Holds `m_generation` for cells reached in this search
+    std::vector<uint32_t> m_closed;      //!< Holds `m_generation` for cells expanded by A*
+    std::vector<uint32_t> m_body_stamp;  //!< Holds `m_generation` for cells under the snake body
+    std::vector<uint32_t> m_vacate;      //!< Last move after which the body still covers a cell
+    std::vector<uint32_t> m_depth;       //!< How many moves the head takes to reach a cell
+    std::vector<Index> m_parent;         //!< Cell from where a cell was reached
+    std::vector<Direction> m_came_from;  //!< Move used to reach a cell from its parent
+    std::vector<Index> m_queue;          //!< BFS frontier, every cell is pushed at most once
+    std::vector<OpenEntry> m_open;       //!< A* open list, a binary heap
+    Index m_start{NO_CELL};              //!< Head cell of the last search
+    uint32_t m_generation{0};            //!< Search counter, avoids clearing the buffers
+    size_t m_expanded{0};                //!< Cells expanded by the last search
+    Index m_best{NO_CELL};               //!< Expanded cell closest to the food, in bounded searches
+    uint32_t m_best_estimate{0};         //!< Estimated distance from `m_best` to the food
+    bool m_interrupted{false};           //!< Tells if the last search ran out of its limit
+
+    /// Grows the buffers, if needed, so they can hold every cell of `maze`. The A* heap is left
+    /// to `a_star`.
+    void fit(const Maze &maze);
+    /// Starts a new search over `body`, invalidating every stamp of the previous one and
+    /// stamping the vacate tick of every body cell
+    void start_search(const Maze &maze, const std::deque<Position> &body);
+    /// Runs a breadth-first search from `start`, already stamped by `start_search`, until
+    /// `target` (it may be `NO_CELL`) is expanded. Returns `false` when every reachable cell was
+    /// expanded first.
+    bool expand_breadth_first(const Maze &maze, Index start, const Direction &head_direction,
+                              Index target, const SearchLimit &limit = {});
+    /// Keeps the expanded `cell` as the best one when its `estimate` is the closest to the food
+    /// so far. Returns `false`, marking the search interrupted, when `limit` ran out.
+    bool keep_going(Index cell, uint32_t estimate, const SearchLimit &limit);
+    /// Writes in `path` the moves to the best cell of a interrupted search. Returns `false`.
+    bool interrupt(std::vector<Direction> &path) const;
+    /// Tells if `to` may be reached from `from`, only ruled out by the maze distance field
+    [[nodiscard]] static bool reachable(const Maze &maze, Index from, Index to) {
+        const auto *distances = maze.distances();
+        return distances == nullptr or distances->reachable(from, to);
+    }
+    /// Tells if the snake body still covers `cell` when the head arrives there in `arrival` moves
+    [[nodiscard]] bool occupied(Index cell, uint32_t arrival) const {
+        return m_body_stamp[cell] == m_generation and arrival <= m_vacate[cell];
+    }
+    /// Writes in `path` the moves from `start` to `end` following the parent links
+    void reconstruct_path(Index start, Index end, std::vector<Direction> &path) const;
+};
+} // namespace snaze
+#endif // !GRID_SEARCH_HPP
@@ -0,0 +1,48 @@
+#ifndef LEVEL_FORMAT_HPP
+#define LEVEL_FORMAT_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace snaze {
+class Maze;
+
+/// Extension of the compiled level files, `Maze` loads them by memory mapping
+constexpr char COMPILED_LEVEL_EXTENSION[] = ".snzb";
+/// First bytes of every compiled level file
+constexpr std::array<char, 4> COMPILED_LEVEL_MAGIC{'S', 'N', 'Z', 'B'};
+/// Layout version of the compiled level files. Version 2 keeps only the free cells reachable
+/// from the spawn.
+constexpr uint32_t COMPILED_LEVEL_VERSION = 2;
+
+/// Header of a compiled level file. It's followed by the payload, made of the maze cells (one
+/// byte each), the wall bitboard (64 bit words) and the free cells (x and y, 32 bit each), in
+/// this order and each one padded to a multiple of 8 bytes, so the whole payload can be copied
+/// straight into a `Maze`. Everything is in host byte order.
+struct CompiledLevelHeader {
+    std::array<char, 4> magic{COMPILED_LEVEL_MAGIC}; //!< Always `COMPILED_LEVEL_MAGIC`
+    uint32_t version{COMPILED_LEVEL_VERSION};        //!< Layout version
+    uint32_t height{0};                              //!< Maze rows
+    uint32_t width{0};                               //!< Maze columns
+    uint32_t spawn_x{0};                             //!< Spawn column
+    uint32_t spawn_y{0};                             //!< Spawn row
+    uint32_t free_cells{0};                          //!< Entries of the free cell list
+    uint32_t reserved{0};                            //!< Keeps the checksum 8 bytes aligned
+    uint64_t checksum{0};                            //!< `compiled_level_checksum` of the payload
+};
+
+/// Rounds `bytes` up to the payload padding
+constexpr size_t compiled_level_padded(size_t bytes) { return (bytes + 7) / 8 * 8; }
+
+/// Checksum of the `size` bytes (a multiple of 8) at `data`, FNV-1a over 64 bit words
+uint64_t compiled_level_checksum(const unsigned char *data, size_t size);
+
+/// Compiles the text level in `level_file` into `compiled_file`, throws on failure
+void compile_level(const std::string &level_file, const std::string &compiled_file);
+/// Writes the already loaded `level` into `compiled_file`, throws on failure, or
+/// `std::invalid_argument` when the level isn't playable (see `LevelIssues`)
+void compile_level(const Maze &level, const std::string &compiled_file);
+} // namespace snaze
+#endif // !LEVEL_FORMAT_HPP
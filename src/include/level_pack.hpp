@@ -0,0 +1,82 @@
+#ifndef LEVEL_PACK_HPP
+#define LEVEL_PACK_HPP
+
+#include <cstddef>
+#include <fstream>
+#include <ios>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "maze.hpp"
+
+namespace snaze {
+/// Separates the pack file from the level offset in a level reference, see `level_ref`
+constexpr char LEVEL_REF_SEPARATOR = '@';
+
+/// Reads the `<height> <width>` header line of a text level
+std::optional<std::pair<size_t, size_t>> read_level_header(const std::string &line);
+
+/// Reference to the level at `offset` of the pack `filename`, a string `Maze` can be loaded from
+std::string level_ref(const std::string &filename, std::streamoff offset);
+
+/// Splits a level reference into the pack file and the level offset, nullopt when `ref` is a
+/// plain file name
+std::optional<std::pair<std::string, std::streamoff>> split_level_ref(const std::string &ref);
+
+/**
+ * @brief A text file with levels written back to back, each one its header and rows.
+ *
+ * The pack is kept open and read lazily: `next` parses one level at a time from where the last
+ * one ended, and `offsets` scans just the headers, skipping rows, to index where every level
+ * starts. A single level file is a pack of one, and a compiled level too, read whole by `Maze`.
+ */
+class LevelPack {
+  public:
+    /// Opens the pack `filename`, throws `std::invalid_argument` when it can't
+    explicit LevelPack(const std::string &filename);
+
+    /// Parses the level after the last one read, nullopt at the end of the pack
+    std::optional<Maze> next(size_t distance_budget = Maze::DEFAULT_DISTANCE_BUDGET);
+    /// Parses the level starting at `offset` of the pack, see `offsets`
+    Maze load(std::streamoff offset, size_t distance_budget = Maze::DEFAULT_DISTANCE_BUDGET);
+    /// Offsets where each level of the pack starts, indexed on the first call
+    const std::vector<std::streamoff> &offsets();
+    /// Returns how many levels are in the pack
+    size_t size() { return offsets().size(); }
+
+    /// References of every level in `filename`: the file itself when it holds a single level,
+    /// one `level_ref` per level otherwise
+    static std::vector<std::string> level_refs(const std::string &filename);
+
+  private:
+    std::string m_filename;                //!< Path of the pack
+    std::ifstream m_file;                  //!< The pack, open for the object lifetime
+    bool m_compiled{false};                //!< Whether it's a compiled level, not a text pack
+    std::streamoff m_next{0};              //!< Where `next` resumes
+    std::vector<std::streamoff> m_offsets; //!< Start of every level, once indexed
+    bool m_indexed{false};                 //!< Whether `m_offsets` was filled
+
+    /// Skips blank lines from `offset` and returns where the header after them starts, with the
+    /// level height, or nullopt when the pack ends or the next line isn't a header
+    std::optional<std::pair<std::streamoff, size_t>> find_header(std::streamoff offset);
+};
+
+/**
+ * @brief Loads levels by reference, keeping the last pack open.
+ *
+ * Consecutive levels of the same pack are read through a single open file, instead of opening
+ * the pack once per level.
+ */
+class LevelLoader {
+  public:
+    /// Loads the level `ref`, a level file or a `level_ref` into a pack
+    Maze load(const std::string &ref, size_t distance_budget = Maze::DEFAULT_DISTANCE_BUDGET);
+
+  private:
+    std::optional<LevelPack> m_pack; //!< Last pack read
+    std::string m_pack_file;         //!< File of `m_pack`
+};
+} // namespace snaze
+#endif // !LEVEL_PACK_HPP
@@ -0,0 +1,58 @@
+#ifndef LEVEL_PREFETCHER_HPP
+#define LEVEL_PREFETCHER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "maze.hpp"
+#include "rng.hpp"
+
+namespace snaze {
+/**
+ * @brief Picks and loads the next level on a background thread.
+ *
+ * Levels are drawn at random, without repetition, from a list of level files. While a level is
+ * played the next one is read, validated and has its distance field built, so `next` only has to
+ * hand it over. Unplayable levels, and the ones that fail to load, are dropped on the way.
+ */
+class LevelPrefetcher {
+  public:
+    /// A level handed over by `next`
+    struct Level {
+        std::string file; //!< Level file or `level_ref` it was loaded from
+        Maze maze;        //!< The loaded level
+    };
+
+    /// Prefetcher with no levels
+    LevelPrefetcher() = default;
+    /// Waits for the level being loaded, if any
+    ~LevelPrefetcher();
+    LevelPrefetcher(const LevelPrefetcher &) = delete;
+    LevelPrefetcher &operator=(const LevelPrefetcher &) = delete;
+    LevelPrefetcher(LevelPrefetcher &&) = delete;
+    LevelPrefetcher &operator=(LevelPrefetcher &&) = delete;
+
+    /// Draws from `level_files` from now on, with a generator seeded `seed`, loading them with
+    /// `distance_budget` (see `Maze`), and starts loading the first one
+    void assign(std::vector<std::string> level_files, size_t distance_budget, uint64_t seed);
+    /// Starts loading the next level in the background, unless it's already loading or loaded
+    void prefetch();
+    /// Hands over the next level, waiting for it if it's still loading, and starts loading the
+    /// one after it. Returns nullopt when no playable level is left.
+    std::optional<Level> next();
+
+  private:
+    std::vector<std::string> m_files;            //!< Level files not drawn yet
+    size_t m_distance_budget{0};                 //!< Distance field budget of every level
+    Rng m_rng;                                   //!< Draws the levels
+    std::future<std::optional<Level>> m_pending; //!< Level being loaded in the background
+
+    /// Draws random files, in O(1) each, until one loads as a playable level, never throwing
+    std::optional<Level> load_next();
+};
+} // namespace snaze
+#endif // !LEVEL_PREFETCHER_HPP
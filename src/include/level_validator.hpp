@@ -0,0 +1,30 @@
+#ifndef LEVEL_VALIDATOR_HPP
+#define LEVEL_VALIDATOR_HPP
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "maze.hpp"
+
+namespace snaze {
+/// Outcome of validating a level
+struct LevelValidation {
+    std::string level;  //!< Level file or `level_ref` that was checked
+    LevelIssues issues; //!< What was found wrong in it
+    std::string error;  //!< Why it couldn't be loaded at all, empty when it could
+
+    /// Whether the level can be played, fixed up or not
+    [[nodiscard]] bool playable() const { return error.empty() and issues.playable(); }
+};
+
+/// Loads and checks every level of `levels` over a pool of `threads` workers, one per hardware
+/// thread when zero. Results keep the order of `levels`.
+std::vector<LevelValidation> validate_levels(const std::vector<std::string> &levels,
+                                             size_t threads = 0);
+
+/// Writes `validations` as CSV in `os`, one line per level
+void write_validations(const std::vector<LevelValidation> &validations, std::ostream &os);
+} // namespace snaze
+#endif // !LEVEL_VALIDATOR_HPP
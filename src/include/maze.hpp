@@ -1,16 +1,47 @@
 #ifndef MAZE_HPP
 #define MAZE_HPP
 
+#include <algorithm>
 #include <array>
+#include <cstdint>
 #include <cstdio>
 #include <deque>
+#include <istream>
 #include <list>
+#include <memory>
+#include <ostream>
 #include <string>
 #include <vector>
 
+#include "distance_field.hpp"
+#include "rng.hpp"
+
 namespace snaze {
 /// A enum to represent directions in a cartesian style
 enum class Direction { Up = 'w', Down = 's', Left = 'a', Right = 'd', None };
+/// Returns the opposite direction of `dir`
+inline Direction opposite(const Direction &dir) {
+    switch (dir) {
+    case Direction::Up:
+        return Direction::Down;
+    case Direction::Down:
+        return Direction::Up;
+    case Direction::Left:
+        return Direction::Right;
+    case Direction::Right:
+        return Direction::Left;
+    default:
+        return Direction::None;
+    }
+}
+/// Moves in the order of their 2 bit codes, see `move_code`
+constexpr std::array<Direction, 4> MOVES{Direction::Up, Direction::Down, Direction::Left,
+                                         Direction::Right};
+/// Returns the 2 bit code moves are packed with in replays and snapshots, throws
+/// `std::invalid_argument` for `Direction::None`
+uint8_t move_code(const Direction &dir);
+/// Returns the move of a 2 bit code, see `move_code`
+inline Direction code_move(uint8_t code) { return MOVES[code & 3U]; }
 /// Data structure that represents a cartesian coordinate
 struct Position {
     size_t coord_x;
@@ -73,12 +104,38 @@ struct Position {
     };
 };
 
+class FreeCellSet;
+
+/// What was found wrong in a level while loading it. Levels with a single spawn, all their rows
+/// and somewhere to put food are fixed up and played, the others are rejected.
+struct LevelIssues {
+    size_t spawns{0};            //!< Spawn cells, a playable level has exactly one
+    size_t missing_rows{0};      //!< Rows the header counts and the file lacks
+    size_t short_rows{0};        //!< Rows narrower than the header width, padded with free cells
+    size_t long_rows{0};         //!< Rows wider than the header width, cut at it
+    size_t unknown_cells{0};     //!< Cells of no known symbol, taken as free
+    size_t free_cells{0};        //!< Free cells reachable from the spawn, where food goes
+    size_t unreachable_cells{0}; //!< Free cells walled off from the spawn, left out of the food
+
+    /// Whether the level can be played at all
+    [[nodiscard]] bool playable() const {
+        return spawns == 1 and missing_rows == 0 and free_cells > 0;
+    }
+    /// Whether a playable level had to be fixed up
+    [[nodiscard]] bool fixed() const {
+        return short_rows + long_rows + unknown_cells + unreachable_cells > 0;
+    }
+};
+
 /// The class that represents a maze as an array, and offers a interface to work
 /// like a puzzle manager.
+///
+/// What was loaded from the level never changes afterwards, so copies of a maze share it and
+/// only have their own food, which makes a copy as cheap as a pointer.
 class Maze {
   public:
     /// Struct that represents what a element of maze array represents
-    enum class Cell {
+    enum class Cell : uint8_t {
         Free = ' ',
         Wall = '#',
         InvisibleWall = '.',
@@ -87,33 +144,115 @@ class Maze {
         SnakeBody,
         SnakeHead,
     };
+    /// Default memory budget of the level distance field, see `distances`
+    static constexpr size_t DEFAULT_DISTANCE_BUDGET = size_t{16} << 20;
+
     /// Construct empty maze
-    Maze() { resize_maze(); }
-    /// Constructor with filename
-    explicit Maze(const std::string &filename);
+    Maze() {
+        auto layout = std::make_shared<Layout>();
+        layout->resize();
+        m_layout = std::move(layout);
+    }
+    /// Constructor with filename, of a text level or of a compiled one (see `level_format.hpp`)
+    /// when it ends in `COMPILED_LEVEL_EXTENSION`, or a `level_ref` into a pack (see
+    /// `level_pack.hpp`). `distance_budget` caps the bytes spent in the distance field built
+    /// along, zero skips it
+    explicit Maze(const std::string &filename, size_t distance_budget = DEFAULT_DISTANCE_BUDGET);
+    /// Constructor reading the text level at the position of `is`, which is left past its rows
+    explicit Maze(std::istream &is, size_t distance_budget = DEFAULT_DISTANCE_BUDGET);
     /// Copy Constructor
     Maze(const Maze &rhs) = default;
+    /// Move Constructor
+    Maze(Maze &&rhs) = default;
     /// Assign operator
     Maze &operator=(const Maze &rhs) = default;
+    /// Move assign operator
+    Maze &operator=(Maze &&rhs) = default;
     /// Return the height of the Maze
-    [[nodiscard]] size_t height() const { return m_height; }
+    [[nodiscard]] size_t height() const { return m_layout->height; }
     /// Return the width of the Maze
-    [[nodiscard]] size_t width() const { return m_width; }
+    [[nodiscard]] size_t width() const { return m_layout->width; }
     /// Given a Position `pos` tells if `pos` is in bounds
     [[nodiscard]] bool in_bound(const Position &pos) const {
-        return (pos.coord_y < m_height and pos.coord_x < m_width);
+        return (pos.coord_y < m_layout->height and pos.coord_x < m_layout->width);
+    }
+    /// Given a Position `pos` returns its index in the row-major maze array
+    [[nodiscard]] size_t index(const Position &pos) const {
+        return pos.coord_y * m_layout->width + pos.coord_x;
+    }
+    /// Given a cell index tells if the cell is a wall, a single bit test
+    [[nodiscard]] bool is_wall(size_t idx) const {
+        return ((m_layout->walls[idx / WALL_WORD_BITS] >> (idx % WALL_WORD_BITS)) & 1U) != 0;
+    }
+    /// Given a in bounds Position `pos` tells if `pos` is a wall
+    [[nodiscard]] bool is_wall(const Position &pos) const { return is_wall(index(pos)); }
+    [[nodiscard]] Position start() const { return m_layout->spawn; }
+    /// Returns where the food is
+    [[nodiscard]] Position food() const { return m_food; }
+    /// Tells if the food was placed already
+    [[nodiscard]] bool has_food() const { return m_has_food; }
+    /// Puts the food at `pos`, as it was in a snapshot of the game, see `GameSnapshot`
+    void place_food(const Position &pos) {
+        m_food = pos;
+        m_has_food = true;
+    }
+    /// Takes the food out of the maze, as it is before the game starts
+    void remove_food() {
+        m_food = Position(0, 0);
+        m_has_food = false;
+    }
+    /// Given a cell index returns the index of the next cell towards `dir`, wrapping around the
+    /// maze borders the same way the snake does
+    [[nodiscard]] size_t step(size_t idx, const Direction &dir) const {
+        const auto width = m_layout->width;
+        const auto height = m_layout->height;
+        auto col = idx % width;
+        auto row = idx / width;
+        switch (dir) {
+        case Direction::Up:
+            return idx - row * width + ((row + height - 1) % height) * width;
+        case Direction::Down:
+            return idx - row * width + ((row + 1) % height) * width;
+        case Direction::Left:
+            return idx - col + (col + width - 1) % width;
+        case Direction::Right:
+            return idx - col + (col + 1) % width;
+        case Direction::None:
+        default:
+            return idx;
+        }
+    }
+    /// Position version of `step`
+    [[nodiscard]] Position step(const Position &pos, const Direction &dir) const {
+        auto idx = step(index(pos), dir);
+        return {idx % m_layout->width, idx / m_layout->width};
     }
-    [[nodiscard]] bool is_wall(const Position &pos) const {
-        return m_maze[pos.coord_y][pos.coord_x] == Cell::Wall;
+    /// Manhattan distance between two positions counting the wraparound of the maze borders
+    [[nodiscard]] size_t torus_distance(const Position &a, const Position &b) const {
+        auto dx = (a.coord_x > b.coord_x) ? a.coord_x - b.coord_x : b.coord_x - a.coord_x;
+        auto dy = (a.coord_y > b.coord_y) ? a.coord_y - b.coord_y : b.coord_y - a.coord_y;
+        return std::min(dx, m_layout->width - dx) + std::min(dy, m_layout->height - dy);
     }
-    [[nodiscard]] Position start() const { return m_spawn; }
+    /// Returns the wall-only distances of the level, if they were built. Copies of a maze share
+    /// them, as the walls never change.
+    [[nodiscard]] const DistanceField *distances() const { return m_layout->distances.get(); }
+    /// Returns the free cells reachable from the spawn, where food may go
+    [[nodiscard]] const std::vector<Position> &free_cells() const {
+        return m_layout->free_cells;
+    }
+    /// Returns what was found wrong in the level when it was loaded
+    [[nodiscard]] const LevelIssues &issues() const { return m_layout->issues; }
+    /// Tells if `other` is a copy of this maze, or this maze a copy of it, sharing its level
+    [[nodiscard]] bool same_level(const Maze &other) const { return m_layout == other.m_layout; }
     /// Given a Position `pos` tells if `pos` is the finish or not
-    [[nodiscard]] bool found_food(const Position &pos) const { return pos == m_food; }
+    [[nodiscard]] bool found_food(const Position &pos) const {
+        return m_has_food and pos == m_food;
+    }
     /// Given a Position `pos` and a direction `dir` see tells if the subsequent
     /// position is acessible or not.
     [[nodiscard]] bool blocked(const Position &pos, const Direction &dir) const {
         auto move = pos + dir;
-        return in_bound(move) and m_maze[move.coord_y][move.coord_x] == Cell::Wall;
+        return in_bound(move) and is_wall(move);
     }
     std::string str_symbols() const;
     /// Method to append the Maze to string, only showing the spawn position
@@ -122,27 +261,65 @@ class Maze {
     //  - snake head: ⸯ (vertical), ~ (horizontal)
     [[nodiscard]] std::string str_in_game(const std::deque<Position> &snake_body,
                                           const Direction &snake_head_direction) const;
+    /// Writes in `canvas` the maze cells, row-major, with the snake painted over them
+    void paint_in_game(const std::deque<Position> &snake_body, std::vector<Cell> &canvas) const;
+    /// Returns how a cell painted by `paint_in_game` is shown on the terminal
+    [[nodiscard]] static std::string str_cell_in_game(const Cell &cell,
+                                                      const Direction &snake_head_direction);
     [[nodiscard]] std::string str_debug(const std::deque<Direction> &solution,
                                         const Position &pos) const;
-    /// Generates a random food position
-    void random_food_position();
+    /// Moves the food to a cell of `open` drawn with `rng`, the food cells the snake isn't on
+    /// (see `Snake::open_cells`), in logarithmic time. Any food cell is taken when there's none
+    /// left. The cell only depends on which cells are open and on `rng`, not on the order the
+    /// snake took them, so a restored game (see `GameSnapshot`) draws the same food again.
+    void random_food_position(const FreeCellSet &open, Rng &rng);
+    /// Writes the maze in the compiled level format, see `level_format.hpp`
+    void write_compiled(std::ostream &os) const;
 
   private:
-    std::vector<std::vector<Cell>> m_maze; //!< The actual Maze
-    size_t m_height{10};                //!< The height of the maze array, i.e. his number of rows.
-    size_t m_width{10};                 //!< The width of the maze array, i.e. his number of lines.
-    Position m_spawn{};                 //!< Where is the start position of the maze puzzle.
-    Position m_food{};                  //!< Where is the end to be found of the maze puzzle.
-    std::vector<Position> m_free_cells; //!< Used for more efficiently generating a food position
+    static constexpr size_t WALL_WORD_BITS = 64; //!< Cells packed in each word of `walls`
 
-    /// Resizes every row of the maze array, it's used as an auxiliary for
-    /// Constructing a object of this class.
-    void resize_maze() {
-        m_maze.resize(m_height);
-        for (auto &row : m_maze) {
-            row.resize(m_width);
+    /// The level as it was loaded. It's only written while the maze is being loaded, before any
+    /// copy of it can share it.
+    struct Layout {
+        std::vector<Cell> cells;          //!< The actual Maze, one byte per cell in row-major order
+        std::vector<uint64_t> walls;      //!< Bitboard with one bit per cell, set for walls
+        size_t height{10};                //!< The height of the maze array, i.e. his number of rows
+        size_t width{10};                 //!< The width of the maze array, i.e. his number of lines
+        Position spawn{0, 0};             //!< Where is the start position of the maze puzzle
+        std::vector<Position> free_cells; //!< Free cells reachable from the spawn, food goes there
+        LevelIssues issues;               //!< Problems found while loading the level
+        std::shared_ptr<const DistanceField> distances; //!< Wall-only distances, if built
+
+        /// Resizes the maze array and the wall bitboard to `height` and `width`, all free
+        void resize() {
+            cells.assign(height * width, Cell::Free);
+            walls.assign((height * width + WALL_WORD_BITS - 1) / WALL_WORD_BITS, 0);
         }
-    }
+        /// Sets the cell at `idx`, keeping the wall bitboard in sync
+        void set_cell(size_t idx, Cell cell) {
+            cells[idx] = cell;
+            if (cell == Cell::Wall) {
+                walls[idx / WALL_WORD_BITS] |= uint64_t{1} << (idx % WALL_WORD_BITS);
+            }
+        }
+    };
+
+    std::shared_ptr<const Layout> m_layout; //!< The level, shared by every copy of the maze
+    Position m_food{0, 0};                  //!< Where is the end to be found of the maze puzzle.
+    bool m_has_food{false};                 //!< Whether `m_food` was placed
+
+    /// Reads a text level into `layout`, cell by cell, noting in its issues what doesn't fit the
+    /// header. Throws `std::invalid_argument` on a bad header
+    void read_text(std::istream &is, Layout &layout);
+    /// Reads a compiled level into `layout`, memory mapped and copied with no parsing, throws
+    /// `std::invalid_argument` when it can't be opened or it's corrupted, a spawn or free cell
+    /// out of the maze included
+    static void read_compiled(const std::string &filename, Layout &layout);
+    /// Fills the free cells of `layout` with the ones in the spawn component, in row-major order
+    void find_free_cells(Layout &layout) const;
+    /// Builds the distance field of `layout` within `distance_budget` bytes, if any
+    void build_distances(Layout &layout, size_t distance_budget) const;
 };
 } // namespace snaze
 #endif // !MAZE_HPP
@@ -0,0 +1,104 @@
+#ifndef REPLAY_HPP
+#define REPLAY_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "mapped_file.hpp"
+#include "maze.hpp"
+
+namespace snaze {
+/// Extension of the replay files
+constexpr char REPLAY_EXTENSION[] = ".snzr";
+/// First bytes of every replay file
+constexpr std::array<char, 4> REPLAY_MAGIC{'S', 'N', 'Z', 'R'};
+/// Layout version of the replay files
+constexpr uint32_t REPLAY_VERSION = 1;
+/// `ReplayHeader::outcome` of a game left before it ended
+constexpr uint8_t REPLAY_UNFINISHED = 0xff;
+
+/// Header of a replay file. It's followed by the level played, as the `level_size` bytes of its
+/// file name or `level_ref`, and by the moves, 2 bits each and 4 to a byte, from the low bits
+/// up. A game played by a bot has a move per tick, one played by a player also has the
+/// direction picked at the start of each life before its moves. Everything is in host byte order.
+struct ReplayHeader {
+    std::array<char, 4> magic{REPLAY_MAGIC}; //!< Always `REPLAY_MAGIC`
+    uint32_t version{REPLAY_VERSION};        //!< Layout version
+    uint64_t seed{0};                        //!< Seed of the game, see `Simulation`
+    uint64_t ticks{0};                       //!< Ticks played
+    uint64_t moves{0};                       //!< 2 bit entries after the level
+    uint32_t lives{0};                       //!< Lives of the game
+    uint32_t food_amount{0};                 //!< Food to be eaten to win
+    uint32_t food_eaten{0};                  //!< Food eaten when the game ended
+    uint32_t lives_lost{0};                  //!< Lives lost when the game ended
+    uint8_t bot_mode{0};                     //!< `BotMode` that played, `Undefined` for a player
+    uint8_t outcome{REPLAY_UNFINISHED};      //!< `GameOutcome` of the game, or unfinished
+    uint16_t reserved{0};                    //!< Keeps `level_size` 4 bytes aligned
+    uint32_t level_size{0};                  //!< Bytes of the level name
+};
+
+/**
+ * @brief Records the moves of a game in a replay file.
+ *
+ * Moves are packed in a block in memory that goes to the file whenever it fills up. The header
+ * is written first with the counters blank, and rewritten by `finish`, or by the destructor
+ * for a game left midway.
+ */
+class ReplayWriter {
+  public:
+    /// Creates `filename` for a game of `level` described by `header`, whose counters and
+    /// outcome are ignored. Throws `std::runtime_error` when the file can't be created.
+    ReplayWriter(const std::string &filename, const std::string &level, ReplayHeader header);
+    /// Finishes the replay as unfinished, unless `finish` was called
+    ~ReplayWriter();
+    ReplayWriter(const ReplayWriter &) = delete;
+    ReplayWriter &operator=(const ReplayWriter &) = delete;
+
+    /// Records the direction of a tick
+    void tick(const Direction &dir) {
+        ++m_header.ticks;
+        push(dir);
+    }
+    /// Records a direction that isn't a tick, the start direction of a player life
+    void push(const Direction &dir);
+    /// Writes what's left of the moves and the final header, with how the game ended
+    void finish(uint8_t outcome, size_t food_eaten, size_t lives_lost);
+
+  private:
+    static constexpr size_t BLOCK_BYTES = 4096; //!< Bytes gathered before writing them
+
+    std::ofstream m_file;         //!< The replay file
+    ReplayHeader m_header;        //!< Header written at the end
+    std::vector<uint8_t> m_block; //!< Packed moves not written yet
+    bool m_finished{false};       //!< Whether `finish` was called
+};
+
+/**
+ * @brief Reads the moves of a replay file, memory mapped.
+ */
+class ReplayReader {
+  public:
+    /// Opens `filename`, throws `std::invalid_argument` when it isn't a whole replay file
+    explicit ReplayReader(const std::string &filename);
+
+    /// Returns the replay header
+    [[nodiscard]] const ReplayHeader &header() const { return m_header; }
+    /// Returns the level the game was played in
+    [[nodiscard]] const std::string &level() const { return m_level; }
+    /// Returns the next move, or nullopt once every move was read
+    std::optional<Direction> next();
+
+  private:
+    MappedFile m_file;                     //!< The replay file
+    ReplayHeader m_header;                 //!< Its header
+    std::string m_level;                   //!< Its level
+    const unsigned char *m_moves{nullptr}; //!< First byte of the moves
+    uint64_t m_read{0};                    //!< Moves read so far
+};
+} // namespace snaze
+#endif // !REPLAY_HPP
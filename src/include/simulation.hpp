@@ -0,0 +1,159 @@
+#ifndef SIMULATION_HPP
+#define SIMULATION_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "game_manager.hpp"
+#include "game_snapshot.hpp"
+#include "maze.hpp"
+#include "replay.hpp"
+#include "rng.hpp"
+#include "snake.hpp"
+
+namespace snaze {
+/// What happened to the snake in a single game tick
+enum class TickOutcome {
+    Moved,   //!< The snake just moved
+    Ate,     //!< The snake ate the food, it grows and the food must be placed again
+    Crashed, //!< The snake hit a wall or it's own body
+};
+
+/// Moves `snake` one cell towards its head direction, wrapping around the maze borders. The tail
+/// is kept when the food was eaten, so the snake grows, the food itself isn't moved.
+TickOutcome advance_snake(const Maze &maze, Snake &snake);
+
+/// How a simulated game has ended
+enum class GameOutcome {
+    Won,     //!< All the food was eaten
+    Lost,    //!< The snake ran out of lives
+    Stalled, //!< The tick limit was reached before the game ended
+};
+
+/// Summary of a simulated game
+struct GameResult {
+    std::string level;                      //!< Level file that was played
+    BotMode bot_mode{BotMode::Undefined};   //!< Bot that played it
+    GameOutcome outcome{GameOutcome::Lost}; //!< How the game ended
+    size_t food_eaten{0};                   //!< Food eaten before the game ended
+    size_t lives_lost{0};                   //!< Lives lost before the game ended
+    size_t ticks{0};                        //!< Simulation ticks (snake moves) played
+    double wall_ms{0};                      //!< Wall-clock time took by the game
+    size_t searches{0};                     //!< Searches run by the bot
+    size_t nodes_expanded{0};               //!< Cells expanded over all the bot searches
+    uint64_t seed{0};                       //!< Seed the game was played with
+    double slowest_think_ms{0};             //!< Wall-clock time took by the slowest bot think
+    size_t slowest_think_tick{0};           //!< Tick the slowest bot think ran at
+};
+
+/// A game played by a bot with no terminal I/O and no frame pacing. It follows the same
+/// GameStart/On/Damage/Won/Lost flow of `SnazeManager` but owns all of its state, so many of them
+/// can be played one after another, or side by side.
+class Simulation {
+  public:
+    /// Constructor, `max_ticks` bounds the game length for bots that can't reach the food and
+    /// `seed` makes every random draw of the game, so the same seed replays the same game. A
+    /// `BotMode::Undefined` game is one of a player, it can only follow a replay.
+    Simulation(std::string level_file, const Settings &settings, BotMode bot_mode,
+               size_t max_ticks, uint64_t seed);
+    /// Constructor for a level already loaded from `level_file`, so games of the same level
+    /// share it, distance field included, instead of loading it again
+    Simulation(std::string level_file, const Maze &level, const Settings &settings,
+               BotMode bot_mode, size_t max_ticks, uint64_t seed);
+    /// Records the moves of the game in `replay_file` as it's played, see `ReplayWriter`
+    void record(const std::string &replay_file);
+    /// Makes the snake follow the moves of `replay` instead of the bot ones, until they run
+    /// out. The bot still thinks whenever it would have, so its searches are timed again, and
+    /// the first tick it would have moved otherwise is kept, see `divergence`.
+    void follow(ReplayReader &replay) { m_replay = &replay; }
+    /// Returns the first tick the bot disagreed with the followed replay, if any
+    [[nodiscard]] std::optional<size_t> divergence() const { return m_divergence; }
+    /// Plays the game until it's won, lost or stalled, going on from where `step` left it
+    GameResult run();
+    /// Plays a single tick, starting the game before the first one. Returns whether the game
+    /// goes on after it, false with nothing played once it's over.
+    bool step();
+    /// Returns the state of the game between two ticks, see `GameSnapshot`
+    [[nodiscard]] GameSnapshot snapshot() const;
+    /// Puts the game back in the state of `snapshot`, taken from this game or from one of the
+    /// same level, settings, bot and seed, and it goes on from there as it did then
+    void restore(const GameSnapshot &snapshot);
+
+  private:
+    std::string m_level_file;               //!< Level file being played
+    Settings m_settings;                    //!< Lives and food amount of the game
+    BotMode m_bot_mode;                     //!< Which bot is playing
+    size_t m_max_ticks;                     //!< Tick limit of the game
+    Maze m_maze;                            //!< Level being played
+    Snake m_snake;                          //!< Snake being moved
+    SnakeBot m_snake_bot;                   //!< Bot that moves the snake
+    size_t m_searches{0};                   //!< Searches run by the bot so far
+    size_t m_nodes_expanded{0};             //!< Cells expanded by the bot searches so far
+    uint64_t m_seed;                        //!< Seed of the game
+    Rng m_rng;                              //!< Draws the food
+    Rng m_bot_rng;                          //!< Draws the random bot moves, apart from the food
+    bool m_started{false};                  //!< Whether the game was started
+    size_t m_ticks{0};                      //!< Ticks played so far
+    size_t m_food_eaten{0};                 //!< Food eaten so far
+    size_t m_lives_lost{0};                 //!< Lives lost so far
+    std::optional<GameOutcome> m_outcome;   //!< How the game ended, once it did
+    double m_slowest_think_ms{0};           //!< Wall-clock time of the slowest bot think so far
+    size_t m_slowest_think_tick{0};         //!< Tick of the slowest bot think so far
+    std::optional<ReplayWriter> m_recorder; //!< Records the moves, when asked to
+    ReplayReader *m_replay{nullptr};        //!< Replay whose moves are followed, if any
+    std::optional<size_t> m_divergence;     //!< First tick the bot disagreed with `m_replay`
+
+    /// Puts the snake back in the spawn and makes the bot plan its first moves
+    void game_start();
+    /// Makes the bot plan its next moves, accounting the search effort
+    void think();
+    /// Returns the move of the tick, from the bot or the followed replay, nullopt once the
+    /// replay ran out
+    std::optional<Direction> next_move();
+};
+
+/// Options of a headless run
+struct HeadlessOptions {
+    std::vector<std::string> level_files;           //!< Levels to be played
+    Settings settings{};                            //!< Lives, food amount and seed of the games
+    std::vector<BotMode> bot_modes{BotMode::Smart}; //!< Bots that play the games
+    size_t games_per_level{1};                      //!< How many games are played in each level
+    size_t max_ticks{100000};                       //!< Tick limit of each game
+    size_t threads{0}; //!< Worker threads of a batch run, zero means one per hardware thread
+    std::string replay_dir; //!< Where the replay of the game `n` is recorded, as `game_<n>`
+};
+
+/// A replay played again, see `verify_replay`
+struct ReplayCheck {
+    GameResult recorded;              //!< The game as the replay tells it
+    GameResult replayed;              //!< The game as it went when played again
+    std::optional<size_t> divergence; //!< First tick the bot would now move otherwise, if any
+
+    /// Whether the game went the same way again
+    [[nodiscard]] bool matches() const {
+        return recorded.outcome == replayed.outcome and recorded.ticks == replayed.ticks and
+               recorded.food_eaten == replayed.food_eaten and
+               recorded.lives_lost == replayed.lives_lost;
+    }
+};
+
+/// Returns the name of a game outcome
+std::string to_string(GameOutcome outcome);
+/// Returns the name of a bot mode
+std::string to_string(BotMode bot_mode);
+/// Plays every game of `options`, writing a CSV line with the result of each game in `os`. The
+/// game `n`, counting from zero in the order they're played, is seeded `settings.seed + n`. The
+/// games of a skipped level keep their numbers.
+void run_headless(const HeadlessOptions &options, std::ostream &os);
+/// Returns the file the replay of the game `game_number` of a run goes to, in `replay_dir`
+std::string replay_file(const std::string &replay_dir, size_t game_number);
+/// Plays the moves of `replay_file` again with no frame pacing, in the level and with the seed,
+/// lives and food amount they were recorded with, `settings` giving the rest. The bot that
+/// played them thinks along as it did, so a slow game can be timed again tick by tick.
+ReplayCheck verify_replay(const std::string &replay_file, Settings settings);
+} // namespace snaze
+#endif // !SIMULATION_HPP
@@ -1,93 +1,178 @@
 #ifndef SNAKE_HPP
 #define SNAKE_HPP
 
-#include <algorithm>
+#include <cstdint>
 #include <deque>
 #include <list>
-#include <map>
 #include <optional>
-#include <queue>
 #include <string>
-#include <unordered_set>
+#include <vector>
 
+#include "free_cell_set.hpp"
+#include "grid_search.hpp"
 #include "maze.hpp"
 
 namespace snaze {
 struct Snake {
-    std::deque<Position> body;
     Direction head_direction{Direction::None};
     /// Default constructor
     Snake() = default;
     /// Copy constructor
     Snake(const Snake &rhs) = default;
-    /// Method to verify if a position corresponds to the snake body
+    /// Returns the snake body, the head being the first element
+    [[nodiscard]] const std::deque<Position> &body() const { return m_body; }
+    /// Method to verify if a position corresponds to the snake body (head excluded), in O(1)
     [[nodiscard]] bool is_snake_body(const Position &position) const {
-        return std::find(body.cbegin() + 1, body.cend(), position) != body.cend();
+        if (not in_grid(position)) {
+            return false;
+        }
+        auto parts = m_occupancy[position.coord_y * m_width + position.coord_x];
+        return parts > (position == m_body.front() ? 1 : 0);
     }
-    /// Resets the snake to it's defaults
-    void reset() {
-        body.clear();
+    /// Resets the snake to it's defaults, fitting the occupancy grid to `maze`
+    void reset(const Maze &maze) {
+        m_body.clear();
+        m_width = maze.width();
+        m_height = maze.height();
+        m_occupancy.assign(m_width * m_height, 0);
+        m_open.reset(maze);
         head_direction = Direction::None;
     }
+    /// Returns the food cells of the maze the snake isn't on, kept as the snake moves
+    [[nodiscard]] const FreeCellSet &open_cells() const { return m_open; }
+    /// Adds a new head to the snake
+    void push_front(const Position &position) {
+        m_body.push_front(position);
+        occupy(position, +1);
+    }
+    /// Adds a new tail to the snake
+    void push_back(const Position &position) {
+        m_body.push_back(position);
+        occupy(position, +1);
+    }
+    /// Removes the snake tail
+    void pop_back() {
+        occupy(m_body.back(), -1);
+        m_body.pop_back();
+    }
+    /// Puts the snake back as it was, with `body` and heading to `direction`, in the maze it was
+    /// last reset to. It takes time in the size of both bodies, not of the maze.
+    void restore(const std::deque<Position> &body, Direction direction) {
+        for (const auto &part : m_body) {
+            occupy(part, -1);
+        }
+        m_body = body;
+        for (const auto &part : m_body) {
+            occupy(part, +1);
+        }
+        head_direction = direction;
+    }
     /// Moves the snake in some direction, and returns the head position
     Position move_snake(const Direction &direction) {
-        body.push_front(body.front() + direction);
-        body.pop_back();
-        return body.front();
+        push_front(m_body.front() + direction);
+        pop_back();
+        return m_body.front();
+    }
+
+  private:
+    std::deque<Position> m_body;
+    std::vector<uint16_t> m_occupancy; //!< How many body parts are on each cell of the maze
+    FreeCellSet m_open;                //!< Food cells with no body part on them
+    size_t m_width{0};                 //!< Width of the maze the occupancy grid was fitted to
+    size_t m_height{0};                //!< Height of the maze the occupancy grid was fitted to
+
+    /// Tells if `position` is covered by the occupancy grid
+    [[nodiscard]] bool in_grid(const Position &position) const {
+        return position.coord_x < m_width and position.coord_y < m_height;
     }
+    /// Adds `delta` to the amount of body parts on `position`
+    void occupy(const Position &position, int delta) {
+        if (not in_grid(position)) {
+            return;
+        }
+        auto cell = position.coord_y * m_width + position.coord_x;
+        m_occupancy[cell] += delta;
+        if (m_occupancy[cell] == 0) {
+            m_open.insert(cell);
+        } else if (delta > 0 and m_occupancy[cell] == 1) {
+            m_open.erase(cell);
+        }
+    }
+};
+/// Enum that represents algorithm that will be used to solve the maze
+enum class BotMode {
+    Smart = 1,
+    Dumb,
+    // Backtracking??
+    Undefined,
 };
 /// Class responsible for finding the shortest path to the finish
 class SnakeBot {
   public:
     using MaybeDirectionDeque = std::optional<std::deque<Direction>>;
-    using PositionUSet = std::unordered_set<Position, Position::Hash>;
 
     MaybeDirectionDeque solution;
 
-    /// Method to solve the maze
-    static MaybeDirectionDeque solve(const Maze &maze, const Snake &snake);
+    /// Constructor, `mode` picks the search used by `solve`
+    explicit SnakeBot(BotMode mode = BotMode::Smart) : m_mode(mode) {}
+    /// Returns the bot mode
+    [[nodiscard]] BotMode mode() const { return m_mode; }
+    /// Changes the bot mode
+    void mode(BotMode mode) { m_mode = mode; }
 
-    /// Method to play the snake randomly, when there's no solution
-    static MaybeDirectionDeque play_random(const Maze &maze, const Snake &snake);
+    /// Method to solve the maze, finding the shortest path from the snake head to the food. The
+    /// smart bot runs A*, the dumb one a breadth-first search. The path is written in `solution`,
+    /// reusing its storage, and `false` is returned, `solution` left as it was, when there's none.
+    /// When the search runs out of `limit` the path leads to the closest cell to the food it got
+    /// to, if any, and `partial` tells so.
+    bool solve(const Maze &maze, const Snake &snake, const SearchLimit &limit = {});
+    /// Method to keep the snake alive while there's no path to the food. Among the moves that
+    /// don't crash right away it picks one after which the head can still reach the tail, so the
+    /// snake can follow it, and then the one that leaves the most room to the head. Returns
+    /// `std::nullopt` when every move crashes.
+    std::optional<Direction> survive(const Maze &maze, const Snake &snake);
+    /// Drops the search kept from the last `survive`, needed when the maze is replaced
+    void forget() { m_kept_maze = nullptr; }
+    /// Returns how many cells the last `solve`, `survive` or `think` has expanded
+    [[nodiscard]] size_t nodes_expanded() const { return m_expanded; }
+    /// Tells if the last `solve` or `think` ran out of its limit, so its solution only heads
+    /// towards the food
+    [[nodiscard]] bool partial() const { return m_partial; }
+
+    /// Method to play the snake randomly, drawing with `rng`, when there's no solution
+    static MaybeDirectionDeque play_random(const Maze &maze, const Snake &snake, Rng &rng);
+    /// Returns a move made with no search, when there's no time for one: keeps the head direction
+    /// when it doesn't crash right away, or else takes the first move that doesn't, if any
+    static Direction fallback_move(const Maze &maze, const Snake &snake);
+
+    /// Fills `solution` with the path to the food or, when there's none, with a move that keeps
+    /// the snake alive, if any, or with a random move drawn with `rng`. Throws a exception when
+    /// not even a move could be made.
+    ///
+    /// While the snake survives the food doesn't move and the body only advances as `survive`
+    /// predicted, so the flood fill it ran for the picked move is already the search of the next
+    /// tick, and no search runs at all then.
+    ///
+    /// A search out of `limit` gives its best path so far, and when it got nowhere the snake
+    /// makes a `fallback_move`, there's no time left for the flood fills of `survive`.
+    void think(const Maze &maze, const Snake &snake, Rng &rng, const SearchLimit &limit = {});
 
   private:
-    /// Method to get the opposite direction
-    static Direction opposite(const Direction &dir) {
-        switch (dir) {
-        case Direction::Up:
-            return Direction::Down;
-        case Direction::Down:
-            return Direction::Up;
-        case Direction::Left:
-            return Direction::Right;
-        case Direction::Right:
-            return Direction::Left;
-        default:
-            return Direction::None;
-        }
-    }
-    /// Method to reconstruct the shorter path from start to the food position
-    static std::deque<Direction> reconstruct_path(std::map<Position, Direction> &came_from,
-                                                  Position start, Position end) {
-        std::deque<Direction> path;
-        Position current = end;
-        while (current != start) {
-            path.push_front(came_from[current]);
-            current = current + opposite(came_from[current]);
-        }
-        return path;
-    }
-    /// Method to verify that a Position was already visited
-    static bool already_visited(const Position &pos, const PositionUSet &visited) {
-        return visited.find(pos) != visited.cend();
-    }
-    /// Method to visit a position and save that o Solver variables
-    static void to_visit_position_append(const Position &pos, std::queue<Position> &to_visit,
-                                         PositionUSet &visited) {
-        to_visit.push(pos);
-        visited.insert(pos);
-    }
+    BotMode m_mode;                   //!< Which search `solve` runs
+    GridSearch m_search;              //!< Reusable search buffers
+    std::vector<Direction> m_path;    //!< Reusable buffer for the path found by `m_search`
+    std::deque<Position> m_moved;     //!< Reusable buffer for the body after a `survive` move
+    GridSearch m_fill;                //!< Buffers for the flood fills of `survive`
+    GridSearch m_kept;                //!< Flood fill of the move picked by the last `survive`
+    std::deque<Position> m_kept_body; //!< Body that `m_kept` was run over
+    const Maze *m_kept_maze{nullptr}; //!< Maze that `m_kept` was run over, if any
+    size_t m_expanded{0};             //!< Cells expanded by the last `solve`, `survive` or `think`
+    bool m_partial{false};            //!< Tells if the last `solve` or `think` ran out of its limit
 
+    /// Makes `moves` the solution, reusing the storage of the last one
+    void plan(const std::vector<Direction> &moves);
+    /// Makes the single `move` the solution, reusing the storage of the last one
+    void plan(Direction move);
     /// Method that given a position on a maze returns the available moves
     static std::vector<Direction> positions_available(const Maze &maze, const Snake &snake);
 };
@@ -0,0 +1,136 @@
+#include "level_format.hpp"
+#include "mapped_file.hpp"
+#include "maze.hpp"
+
+#include <array>
+#include <cstring>
+#include <fstream>
+#include <optional>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+/// Writes `size` bytes of `data` in `os`, followed by zeros up to the payload padding
+void write_padded(std::ostream &os, const void *data, size_t size) {
+    constexpr std::array<char, 8> zeros{};
+    os.write(static_cast<const char *>(data), static_cast<std::streamsize>(size));
+    auto padding = snaze::compiled_level_padded(size) - size;
+    os.write(zeros.data(), static_cast<std::streamsize>(padding));
+}
+} // namespace
+
+namespace snaze {
+uint64_t compiled_level_checksum(const unsigned char *data, size_t size) {
+    uint64_t hash = 0xcbf29ce484222325ULL;
+    for (size_t offset = 0; offset < size; offset += sizeof(uint64_t)) {
+        uint64_t word = 0;
+        std::memcpy(&word, data + offset, sizeof(word));
+        hash = (hash ^ word) * 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+void compile_level(const std::string &level_file, const std::string &compiled_file) {
+    compile_level(Maze(level_file, 0), compiled_file);
+}
+
+void compile_level(const Maze &level, const std::string &compiled_file) {
+    if (not level.issues().playable()) {
+        throw std::invalid_argument("Unplayable level: " + compiled_file);
+    }
+    std::ofstream ofs(compiled_file, std::ios::binary | std::ios::trunc);
+    if (not ofs.is_open()) {
+        throw std::runtime_error("Couldn't create file: " + compiled_file);
+    }
+    level.write_compiled(ofs);
+    if (not ofs.good()) {
+        throw std::runtime_error("Couldn't write file: " + compiled_file);
+    }
+}
+
+void Maze::write_compiled(std::ostream &os) const {
+    const auto &layout = *m_layout;
+    std::vector<uint32_t> free_cells;
+    free_cells.reserve(layout.free_cells.size() * 2);
+    for (const auto &pos : layout.free_cells) {
+        free_cells.push_back(static_cast<uint32_t>(pos.coord_x));
+        free_cells.push_back(static_cast<uint32_t>(pos.coord_y));
+    }
+    // The payload is built in memory first, the checksum goes in the header before it
+    std::ostringstream payload;
+    write_padded(payload, layout.cells.data(), layout.cells.size());
+    write_padded(payload, layout.walls.data(), layout.walls.size() * sizeof(uint64_t));
+    write_padded(payload, free_cells.data(), free_cells.size() * sizeof(uint32_t));
+    const auto bytes = payload.str();
+
+    CompiledLevelHeader header;
+    header.height = static_cast<uint32_t>(layout.height);
+    header.width = static_cast<uint32_t>(layout.width);
+    header.spawn_x = static_cast<uint32_t>(layout.spawn.coord_x);
+    header.spawn_y = static_cast<uint32_t>(layout.spawn.coord_y);
+    header.free_cells = static_cast<uint32_t>(layout.free_cells.size());
+    header.checksum = compiled_level_checksum(
+        reinterpret_cast<const unsigned char *>(bytes.data()), bytes.size());
+    os.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    os.write(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+}
+
+void Maze::read_compiled(const std::string &filename, Layout &layout) {
+    std::optional<MappedFile> mapped;
+    try {
+        mapped.emplace(filename);
+    } catch (const std::runtime_error &error) {
+        throw std::invalid_argument(error.what());
+    }
+    const auto &file = mapped.value();
+    CompiledLevelHeader header;
+    if (file.size() < sizeof(header)) {
+        throw std::invalid_argument("Corrupted level file: " + filename);
+    }
+    std::memcpy(&header, file.data(), sizeof(header));
+    if (header.magic != COMPILED_LEVEL_MAGIC or header.version != COMPILED_LEVEL_VERSION) {
+        throw std::invalid_argument("Not a compiled level file: " + filename);
+    }
+    layout.height = header.height;
+    layout.width = header.width;
+    const auto cells = layout.height * layout.width;
+    const auto cells_bytes = compiled_level_padded(cells);
+    const auto walls_bytes = (cells + WALL_WORD_BITS - 1) / WALL_WORD_BITS * sizeof(uint64_t);
+    const auto free_bytes = size_t{header.free_cells} * 2 * sizeof(uint32_t);
+    const auto *payload = file.data() + sizeof(header);
+    const auto payload_bytes = file.size() - sizeof(header);
+    if (payload_bytes != cells_bytes + walls_bytes + free_bytes or
+        compiled_level_checksum(payload, payload_bytes) != header.checksum) {
+        throw std::invalid_argument("Corrupted level file: " + filename);
+    }
+    // The checksum only tells the file is as written, not that it was written right
+    if (header.spawn_x >= header.width or header.spawn_y >= header.height or
+        header.free_cells > cells) {
+        throw std::invalid_argument("Corrupted level file: " + filename);
+    }
+
+    // The mapping is page aligned and every section 8 bytes aligned, so they're read in place
+    const auto *maze_cells = reinterpret_cast<const Cell *>(payload);
+    layout.cells.assign(maze_cells, maze_cells + cells);
+    const auto *walls = reinterpret_cast<const uint64_t *>(payload + cells_bytes);
+    layout.walls.assign(walls, walls + walls_bytes / sizeof(uint64_t));
+    const auto *free_cells =
+        reinterpret_cast<const uint32_t *>(payload + cells_bytes + walls_bytes);
+    layout.free_cells.clear();
+    layout.free_cells.reserve(header.free_cells);
+    for (size_t i = 0; i < header.free_cells; ++i) {
+        if (free_cells[2 * i] >= header.width or free_cells[2 * i + 1] >= header.height) {
+            throw std::invalid_argument("Corrupted level file: " + filename);
+        }
+        layout.free_cells.emplace_back(free_cells[2 * i], free_cells[2 * i + 1]);
+    }
+    layout.spawn = Position(header.spawn_x, header.spawn_y);
+    // Only playable levels are compiled, and fixed up already
+    layout.issues = LevelIssues{};
+    layout.issues.spawns = 1;
+    layout.issues.free_cells = header.free_cells;
+}
+} // namespace snaze
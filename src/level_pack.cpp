@@ -0,0 +1,146 @@
+#include "level_pack.hpp"
+#include "level_format.hpp"
+
+#include <cctype>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+namespace snaze {
+std::optional<std::pair<size_t, size_t>> read_level_header(const std::string &line) {
+    std::istringstream iss(line);
+    size_t height = 0;
+    size_t width = 0;
+    iss >> height >> width;
+    if (iss.fail() or iss.bad()) {
+        return std::nullopt;
+    }
+    return std::make_pair(height, width);
+}
+
+std::string level_ref(const std::string &filename, std::streamoff offset) {
+    return filename + LEVEL_REF_SEPARATOR + std::to_string(offset);
+}
+
+std::optional<std::pair<std::string, std::streamoff>> split_level_ref(const std::string &ref) {
+    auto separator = ref.rfind(LEVEL_REF_SEPARATOR);
+    if (separator == std::string::npos or separator + 1 == ref.size()) {
+        return std::nullopt;
+    }
+    for (auto idx = separator + 1; idx < ref.size(); ++idx) {
+        if (not std::isdigit(static_cast<unsigned char>(ref[idx]))) {
+            return std::nullopt;
+        }
+    }
+    return std::make_pair(ref.substr(0, separator), std::stoll(ref.substr(separator + 1)));
+}
+
+LevelPack::LevelPack(const std::string &filename) : m_filename(filename), m_file(filename) {
+    if (not m_file.is_open()) {
+        throw std::invalid_argument("Couldn't open file: " + filename);
+    }
+    auto extension = std::string_view(COMPILED_LEVEL_EXTENSION);
+    m_compiled =
+        filename.size() >= extension.size() and
+        filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+std::optional<Maze> LevelPack::next(size_t distance_budget) {
+    if (m_next < 0) {
+        return std::nullopt;
+    }
+    if (m_compiled) {
+        m_next = -1;
+        return Maze(m_filename, distance_budget);
+    }
+    auto header = find_header(m_next);
+    if (not header.has_value()) {
+        m_next = -1;
+        return std::nullopt;
+    }
+    auto maze = load(header.value().first, distance_budget);
+    m_next = m_file.tellg(); // -1 once the last row hit the end of the file
+    return maze;
+}
+
+Maze LevelPack::load(std::streamoff offset, size_t distance_budget) {
+    if (m_compiled) {
+        return Maze(m_filename, distance_budget);
+    }
+    m_file.clear();
+    m_file.seekg(offset);
+    return Maze(m_file, distance_budget);
+}
+
+const std::vector<std::streamoff> &LevelPack::offsets() {
+    if (m_indexed) {
+        return m_offsets;
+    }
+    m_indexed = true;
+    if (m_compiled) {
+        m_offsets.push_back(0);
+        return m_offsets;
+    }
+    std::streamoff offset = 0;
+    while (auto header = find_header(offset)) {
+        m_offsets.push_back(header.value().first);
+        // Rows are skipped unparsed, up to the next header
+        for (size_t row = 0; row < header.value().second and m_file; ++row) {
+            m_file.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        }
+        offset = m_file.tellg();
+        if (offset < 0) {
+            break;
+        }
+    }
+    return m_offsets;
+}
+
+std::optional<std::pair<std::streamoff, size_t>> LevelPack::find_header(std::streamoff offset) {
+    m_file.clear();
+    m_file.seekg(offset);
+    std::string line;
+    while (true) {
+        std::streamoff start = m_file.tellg();
+        if (not std::getline(m_file, line)) {
+            return std::nullopt;
+        }
+        if (line.find_first_not_of(" \t\r") == std::string::npos) {
+            continue;
+        }
+        // Anything else past a level is left to it, the same as in a single level file
+        auto dimensions = read_level_header(line);
+        if (not dimensions.has_value()) {
+            return std::nullopt;
+        }
+        return std::make_pair(start, dimensions.value().first);
+    }
+}
+
+std::vector<std::string> LevelPack::level_refs(const std::string &filename) {
+    LevelPack pack(filename);
+    const auto &offsets = pack.offsets();
+    if (offsets.size() <= 1) {
+        return {filename};
+    }
+    std::vector<std::string> refs;
+    refs.reserve(offsets.size());
+    for (const auto &offset : offsets) {
+        refs.push_back(level_ref(filename, offset));
+    }
+    return refs;
+}
+
+Maze LevelLoader::load(const std::string &ref, size_t distance_budget) {
+    auto split = split_level_ref(ref);
+    if (not split.has_value()) {
+        return Maze(ref, distance_budget);
+    }
+    if (not m_pack.has_value() or m_pack_file != split.value().first) {
+        m_pack.emplace(split.value().first);
+        m_pack_file = split.value().first;
+    }
+    return m_pack->load(split.value().second, distance_budget);
+}
+} // namespace snaze
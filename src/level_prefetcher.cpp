@@ -0,0 +1,63 @@
+#include "level_prefetcher.hpp"
+
+#include <exception>
+#include <optional>
+#include <utility>
+
+namespace snaze {
+LevelPrefetcher::~LevelPrefetcher() {
+    if (m_pending.valid()) {
+        m_pending.wait();
+    }
+}
+
+void LevelPrefetcher::assign(std::vector<std::string> level_files, size_t distance_budget,
+                             uint64_t seed) {
+    if (m_pending.valid()) {
+        m_pending.wait();
+        m_pending = {};
+    }
+    m_files = std::move(level_files);
+    m_distance_budget = distance_budget;
+    m_rng.seed(seed);
+    prefetch();
+}
+
+void LevelPrefetcher::prefetch() {
+    if (m_pending.valid() or m_files.empty()) {
+        return;
+    }
+    // `m_files` and `m_rng` are only touched by the task until `next` collects it
+    m_pending = std::async(std::launch::async, [this] { return load_next(); });
+}
+
+std::optional<LevelPrefetcher::Level> LevelPrefetcher::next() {
+    prefetch();
+    if (not m_pending.valid()) {
+        return std::nullopt;
+    }
+    auto level = m_pending.get();
+    prefetch();
+    return level;
+}
+
+std::optional<LevelPrefetcher::Level> LevelPrefetcher::load_next() {
+    while (not m_files.empty()) {
+        // The drawn file swaps places with the last one, so it leaves the list in O(1)
+        auto idx = m_rng.below(m_files.size());
+        std::swap(m_files[idx], m_files.back());
+        auto file = std::move(m_files.back());
+        m_files.pop_back();
+        std::optional<Maze> level;
+        try {
+            level.emplace(file, m_distance_budget);
+        } catch (const std::exception &) {
+            continue; // Unreadable, dropped as the unplayable ones
+        }
+        if (level.value().issues().playable()) {
+            return Level{std::move(file), std::move(level.value())};
+        }
+    }
+    return std::nullopt;
+}
+} // namespace snaze
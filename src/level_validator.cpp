@@ -0,0 +1,58 @@
+#include "level_validator.hpp"
+#include "level_pack.hpp"
+#include "thread_pool.hpp"
+
+#include <algorithm>
+#include <exception>
+
+namespace {
+/// Status column of a validation: whether the level is played as is, fixed up or not at all
+const char *status(const snaze::LevelValidation &validation) {
+    if (not validation.error.empty()) {
+        return "error";
+    }
+    if (not validation.issues.playable()) {
+        return "rejected";
+    }
+    return validation.issues.fixed() ? "fixed" : "ok";
+}
+} // namespace
+
+namespace snaze {
+std::vector<LevelValidation> validate_levels(const std::vector<std::string> &levels,
+                                             size_t threads) {
+    std::vector<LevelValidation> validations(levels.size());
+    ThreadPool pool(threads);
+    // Levels go in runs, so each task reads the levels of a pack through one open file
+    const auto run = std::max<size_t>(1, levels.size() / (pool.size() * 4));
+    for (size_t first = 0; first < levels.size(); first += run) {
+        pool.submit([&levels, &validations, first, run] {
+            LevelLoader loader;
+            for (auto idx = first; idx < std::min(first + run, levels.size()); ++idx) {
+                auto &validation = validations[idx];
+                validation.level = levels[idx];
+                try {
+                    validation.issues = loader.load(levels[idx], 0).issues();
+                } catch (const std::exception &e) {
+                    validation.error = e.what();
+                }
+            }
+        });
+    }
+    pool.wait();
+    return validations;
+}
+
+void write_validations(const std::vector<LevelValidation> &validations, std::ostream &os) {
+    os << "level,status,spawns,missing_rows,short_rows,long_rows,unknown_cells,free_cells,"
+          "unreachable_cells,error\n";
+    for (const auto &validation : validations) {
+        const auto &issues = validation.issues;
+        os << validation.level << ',' << status(validation) << ',' << issues.spawns << ','
+           << issues.missing_rows << ',' << issues.short_rows << ',' << issues.long_rows << ','
+           << issues.unknown_cells << ',' << issues.free_cells << ',' << issues.unreachable_cells
+           << ',' << validation.error << '\n';
+    }
+    os.flush();
+}
+} // namespace snaze
@@ -1,8 +1,261 @@
+#include "batch_runner.hpp"
 #include "game_manager.hpp"
+#include "ini_file_parser.h"
+#include "level_format.hpp"
+#include "level_pack.hpp"
+#include "level_validator.hpp"
 #include "maze.hpp"
+#include "rng.hpp"
+#include "simulation.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+void usage(const char *program) {
+    std::cerr << "Usage: " << program << " [--headless|--batch [options]]\n"
+              << "       " << program << " --compile <level file or directory> <output directory>\n"
+              << "       " << program << " --validate <level file or directory>\n"
+              << "       " << program << " --replay <replay file or directory>\n"
+              << "  --headless        Plays bot games with no terminal I/O nor frame pacing\n"
+              << "  --batch           Plays bot games in parallel, printing a summary per level\n"
+              << "  --levels <path>   Level file, pack or directory of them (default: assets/)\n"
+              << "  --config <file>   Ini config file (default: conf/snaze_config.ini)\n"
+              << "  --games <n>       Games played in each level (default: 1)\n"
+              << "  --bot <mode>      Bot that plays, smart, dumb or all (default: smart)\n"
+              << "  --max-ticks <n>   Tick limit of each game (default: 100000)\n"
+              << "  --threads <n>     Batch worker threads (default: one per hardware thread)\n"
+              << "  --seed <n>        Seed of the first game, the next ones add one each "
+                 "(default: config, random if 0)\n"
+              << "  --replays <dir>   Records a replay of every game in the directory\n"
+              << "  --compile         Compiles text levels into the binary format ("
+              << snaze::COMPILED_LEVEL_EXTENSION << "), loaded with no parsing\n"
+              << "  --validate        Checks levels in parallel, exits with failure if some is "
+                 "unplayable\n"
+              << "  --replay          Plays replays again at full speed, exits with failure if "
+                 "some ends otherwise\n";
+}
+
+/// Returns the levels in `path`, a directory of level files and packs, or a single one of them
+std::vector<std::string> list_levels(const std::string &path) {
+    if (std::filesystem::is_directory(path)) {
+        return snaze::get_files_from_directory(path);
+    }
+    return snaze::LevelPack::level_refs(path);
+}
+
+/// Compiles the text level `input`, or every level in the directory `input`, into `output_dir`.
+/// The levels of a pack are streamed from it, and numbered after the pack name
+void compile_levels(const std::string &input, const std::string &output_dir) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> level_files{input};
+    if (fs::is_directory(input)) {
+        level_files.clear();
+        for (const auto &entry : fs::directory_iterator(input)) {
+            if (fs::is_regular_file(entry)) {
+                level_files.emplace_back(entry.path().string());
+            }
+        }
+        std::sort(level_files.begin(), level_files.end());
+    }
+    fs::create_directories(output_dir);
+    for (const auto &level_file : level_files) {
+        snaze::LevelPack pack(level_file);
+        const auto levels = pack.size();
+        size_t level_idx = 0;
+        while (auto level = pack.next(0)) {
+            if (not level.value().issues().playable()) {
+                std::cout << level_file << " [" << level_idx++ << "] is unplayable, skipped\n";
+                continue;
+            }
+            auto name = fs::path(level_file).stem();
+            if (levels > 1) {
+                name += "_" + std::to_string(level_idx);
+            }
+            auto compiled = fs::path(output_dir) / name.concat(snaze::COMPILED_LEVEL_EXTENSION);
+            snaze::compile_level(level.value(), compiled.string());
+            std::cout << level_file;
+            if (levels > 1) {
+                std::cout << " [" << level_idx << ']';
+            }
+            std::cout << " -> " << compiled.string() << '\n';
+            ++level_idx;
+        }
+    }
+}
+
+/// Plays again the replay `input`, or every replay in the directory `input`, printing a CSV
+/// line with how each one went. Returns whether every replay ended the way it was recorded.
+bool verify_replays(const std::string &input) {
+    namespace fs = std::filesystem;
+    std::vector<std::string> replay_files{input};
+    if (fs::is_directory(input)) {
+        replay_files.clear();
+        for (const auto &entry : fs::directory_iterator(input)) {
+            if (entry.path().extension() == snaze::REPLAY_EXTENSION) {
+                replay_files.emplace_back(entry.path().string());
+            }
+        }
+        std::sort(replay_files.begin(), replay_files.end());
+    }
+    auto settings = ini::Parser::file("conf/snaze_config.ini");
+    bool all_match = true;
+    std::cout << "replay,level,bot,seed,ticks,outcome,replayed_ticks,replayed_outcome,match,"
+                 "divergence,wall_ms,slowest_think_ms,slowest_think_tick\n";
+    for (const auto &replay_file : replay_files) {
+        auto check = snaze::verify_replay(replay_file, settings);
+        const auto &recorded = check.recorded;
+        const auto &replayed = check.replayed;
+        all_match = all_match and check.matches();
+        std::cout << replay_file << ',' << recorded.level << ','
+                  << ((recorded.bot_mode == snaze::BotMode::Undefined)
+                          ? "player"
+                          : snaze::to_string(recorded.bot_mode))
+                  << ',' << recorded.seed << ',' << recorded.ticks << ','
+                  << snaze::to_string(recorded.outcome) << ',' << replayed.ticks << ','
+                  << snaze::to_string(replayed.outcome) << ','
+                  << (check.matches() ? "yes" : "no") << ',';
+        if (check.divergence.has_value()) {
+            std::cout << check.divergence.value();
+        }
+        std::cout << ',' << replayed.wall_ms << ',' << replayed.slowest_think_ms << ','
+                  << replayed.slowest_think_tick << '\n';
+    }
+    return all_match;
+}
+
+/// Reads the headless and batch options from the command line, throws on invalid arguments
+snaze::HeadlessOptions read_headless_options(int argc, char *argv[]) {
+    snaze::HeadlessOptions options;
+    std::string levels_path = "assets/";
+    std::string config_path = "conf/snaze_config.ini";
+    uint64_t seed = 0;
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--headless" or arg == "--batch") {
+            continue;
+        }
+        if (i + 1 >= argc) {
+            throw std::invalid_argument("Missing value for " + arg);
+        }
+        std::string value = argv[++i];
+        if (arg == "--levels") {
+            levels_path = value;
+        } else if (arg == "--config") {
+            config_path = value;
+        } else if (arg == "--games") {
+            options.games_per_level = std::stoul(value);
+        } else if (arg == "--max-ticks") {
+            options.max_ticks = std::stoul(value);
+        } else if (arg == "--threads") {
+            options.threads = std::stoul(value);
+        } else if (arg == "--seed") {
+            seed = std::stoull(value);
+        } else if (arg == "--replays") {
+            options.replay_dir = value;
+            std::filesystem::create_directories(value);
+        } else if (arg == "--bot") {
+            if (value == "smart") {
+                options.bot_modes = {snaze::BotMode::Smart};
+            } else if (value == "dumb") {
+                options.bot_modes = {snaze::BotMode::Dumb};
+            } else if (value == "all") {
+                options.bot_modes = {snaze::BotMode::Smart, snaze::BotMode::Dumb};
+            } else {
+                throw std::invalid_argument("Unknown bot: " + value);
+            }
+        } else {
+            throw std::invalid_argument("Unknown option: " + arg);
+        }
+    }
+    options.level_files = list_levels(levels_path);
+    options.settings = ini::Parser::file(config_path);
+    if (seed != 0) {
+        options.settings.seed = seed;
+    }
+    if (options.settings.seed == 0) {
+        options.settings.seed = Rng::random_seed();
+    }
+    return options;
+}
+} // namespace
 
 int main(int argc, char *argv[]) {
+    if (argc > 1 and std::strcmp(argv[1], "--help") == 0) {
+        usage(argv[0]);
+        return 0;
+    }
+    if (argc > 1 and std::strcmp(argv[1], "--compile") == 0) {
+        if (argc != 4) {
+            usage(argv[0]);
+            return 1;
+        }
+        try {
+            compile_levels(argv[2], argv[3]);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 1 and std::strcmp(argv[1], "--validate") == 0) {
+        if (argc != 3) {
+            usage(argv[0]);
+            return 1;
+        }
+        try {
+            auto validations = snaze::validate_levels(list_levels(argv[2]));
+            snaze::write_validations(validations, std::cout);
+            return std::all_of(validations.begin(), validations.end(),
+                               [](const auto &validation) { return validation.playable(); })
+                       ? 0
+                       : 1;
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+    }
+    if (argc > 1 and std::strcmp(argv[1], "--replay") == 0) {
+        if (argc != 3) {
+            usage(argv[0]);
+            return 1;
+        }
+        try {
+            return verify_replays(argv[2]) ? 0 : 1;
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            return 1;
+        }
+    }
+    if (argc > 1 and std::strcmp(argv[1], "--headless") == 0) {
+        try {
+            snaze::run_headless(read_headless_options(argc, argv), std::cout);
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            usage(argv[0]);
+            return 1;
+        }
+        return 0;
+    }
+    if (argc > 1 and std::strcmp(argv[1], "--batch") == 0) {
+        try {
+            auto report = snaze::run_batch(read_headless_options(argc, argv));
+            snaze::write_report(report, std::cout);
+            std::cerr << "Batch took " << report.wall_ms << " ms on " << report.threads
+                      << " threads, seed " << report.seed << '\n';
+        } catch (const std::exception &e) {
+            std::cerr << e.what() << '\n';
+            usage(argv[0]);
+            return 1;
+        }
+        return 0;
+    }
     snaze::SnazeManager snaze("assets/", "conf/snaze_config.ini");
     while (not snaze.quit()) {
         snaze.process();
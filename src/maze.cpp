@@ -1,16 +1,22 @@
 #include "maze.hpp"
 
+#include <algorithm>
 #include <deque>
-#include <experimental/random>
 #include <fstream>
 #include <istream>
+#include <memory>
 #include <optional>
 #include <sstream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 #include <utility>
+#include <vector>
 
 #include "color.h"
+#include "free_cell_set.hpp"
+#include "level_format.hpp"
+#include "level_pack.hpp"
 
 namespace {
 std::optional<std::ifstream> open_file(const std::string &filename) {
@@ -20,54 +26,129 @@ std::optional<std::ifstream> open_file(const std::string &filename) {
     }
     return ifs_file;
 }
+} // namespace
 
-std::optional<std::pair<size_t, size_t>> read_array_dimensions(const std::string &line) {
-    std::istringstream iss(line);
-    size_t height = 0;
-    size_t width = 0;
-    iss >> height >> width;
-    if (iss.fail() or iss.bad()) {
-        return std::nullopt;
+namespace snaze {
+uint8_t move_code(const Direction &dir) {
+    for (uint8_t code = 0; code < MOVES.size(); ++code) {
+        if (MOVES[code] == dir) {
+            return code;
+        }
     }
-    return std::make_pair(height, width);
+    throw std::invalid_argument("Not a move");
 }
-} // namespace
 
-namespace snaze {
-Maze::Maze(const std::string &filename) : m_spawn(0, 0), m_food(0, 0) {
-    auto file = open_file(filename);
-    if (not file.has_value()) {
+Maze::Maze(const std::string &filename, size_t distance_budget) {
+    auto layout = std::make_shared<Layout>();
+    m_layout = layout; // Read along as it loads, for the searches over it
+    auto extension = std::string_view(COMPILED_LEVEL_EXTENSION);
+    if (filename.size() >= extension.size() and
+        filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0) {
+        read_compiled(filename, *layout);
+    } else if (auto file = open_file(filename)) {
+        read_text(file.value(), *layout);
+    } else if (auto ref = split_level_ref(filename)) {
+        // A level inside a pack, see `LevelPack::level_refs`
+        auto pack = open_file(ref.value().first);
+        if (not pack.has_value()) {
+            throw std::invalid_argument("Couldn't open file: " + ref.value().first);
+        }
+        pack.value().seekg(ref.value().second);
+        read_text(pack.value(), *layout);
+    } else {
         throw std::invalid_argument("Couldn't open file: " + filename);
     }
+    build_distances(*layout, distance_budget);
+}
+
+Maze::Maze(std::istream &is, size_t distance_budget) {
+    auto layout = std::make_shared<Layout>();
+    m_layout = layout;
+    read_text(is, *layout);
+    build_distances(*layout, distance_budget);
+}
+
+void Maze::build_distances(Layout &layout, size_t distance_budget) const {
+    if (distance_budget > 0) {
+        auto distances = std::make_shared<DistanceField>(*this, distance_budget);
+        if (not distances->empty()) {
+            layout.distances = std::move(distances);
+        }
+    }
+}
+
+void Maze::read_text(std::istream &is, Layout &layout) {
     std::string file_line;
+    std::optional<std::pair<size_t, size_t>> dimensions;
+    if (std::getline(is, file_line)) {
+        dimensions = read_level_header(file_line);
+    }
+    if (not dimensions.has_value()) {
+        throw std::invalid_argument("Failed in reading header for maze file");
+    }
+    layout.height = dimensions.value().first;
+    layout.width = dimensions.value().second;
+    layout.resize();
+    // Exactly `layout.height` rows are read, the stream is left at whatever follows the level
     size_t line_count = 0;
-    bool first_line = true;
-    while (std::getline(file.value(), file_line)) {
-        if (first_line) {
-            auto dimensions = read_array_dimensions(file_line);
-            if (not dimensions.has_value()) {
-                throw std::invalid_argument("Failed in reading header for maze file");
+    for (; line_count < layout.height and std::getline(is, file_line); ++line_count) {
+        if (file_line.size() > layout.width) {
+            // Columns past the header width would land outside the maze
+            ++layout.issues.long_rows;
+        } else if (file_line.size() < layout.width) {
+            ++layout.issues.short_rows; // The rest of the row stays free
+        }
+        const auto columns = std::min(file_line.size(), layout.width);
+        for (size_t col_count = 0; col_count < columns; ++col_count) {
+            auto cell = (Cell)file_line[col_count];
+            switch (cell) {
+            case Cell::Spawn:
+                ++layout.issues.spawns;
+                layout.spawn = Position(col_count, line_count);
+                break;
+            case Cell::Free:
+            case Cell::Wall:
+            case Cell::InvisibleWall:
+                break;
+            default:
+                ++layout.issues.unknown_cells;
+                cell = Cell::Free;
             }
-            m_height = dimensions.value().first;
-            m_width = dimensions.value().second;
-            resize_maze();
-            first_line = false;
-            continue;
+            layout.set_cell(line_count * layout.width + col_count, cell);
         }
-        size_t col_count = 0;
-        for (const auto &chr : file_line) {
-            auto cell = (Cell)chr;
-            if (cell == Cell::Spawn) {
-                m_spawn = Position(col_count, line_count);
-            } else if (cell == Cell::Free) {
-                m_free_cells.emplace_back(col_count, line_count);
+    }
+    layout.issues.missing_rows = layout.height - line_count;
+    find_free_cells(layout);
+}
+
+void Maze::find_free_cells(Layout &layout) const {
+    layout.free_cells.clear();
+    if (layout.issues.spawns != 1) {
+        return; // Rejected anyway, there's no single place to reach the food from
+    }
+    std::vector<bool> reached(layout.cells.size(), false);
+    std::vector<size_t> queue{index(layout.spawn)};
+    reached[queue.front()] = true;
+    for (size_t queue_head = 0; queue_head < queue.size(); ++queue_head) {
+        for (const auto &dir : {Direction::Up, Direction::Down, Direction::Left, Direction::Right}) {
+            auto next = step(queue[queue_head], dir);
+            if (not is_wall(next) and not reached[next]) {
+                reached[next] = true;
+                queue.push_back(next);
             }
-            m_maze[line_count][col_count++] = cell;
         }
-        line_count++;
     }
-    // FIX: Error treatment for problematic levels
-    // TODO: Functionality to read a file with multiple levels
+    for (size_t idx = 0; idx < layout.cells.size(); ++idx) {
+        if (layout.cells[idx] != Cell::Free) {
+            continue;
+        }
+        if (reached[idx]) {
+            layout.free_cells.emplace_back(idx % layout.width, idx / layout.width);
+        } else {
+            ++layout.issues.unreachable_cells;
+        }
+    }
+    layout.issues.free_cells = layout.free_cells.size();
 }
 
 std::string line(size_t n) {
@@ -97,8 +178,12 @@ std::string Maze::str_spawn() const {
     constexpr char food[] = "◉";
     size_t line_length = 50;
     std::ostringstream oss;
-    for (const auto &row : m_maze) {
-        for (const auto &cell : row) {
+    for (size_t row = 0; row < height(); ++row) {
+        for (size_t col = 0; col < width(); ++col) {
+            auto cell = m_layout->cells[row * width() + col];
+            if (m_has_food and m_food == Position(col, row)) {
+                cell = Cell::Food;
+            }
             if (cell == Cell::Free or cell == Cell::InvisibleWall) {
                 oss << free;
             } else if (cell == Cell::Wall) {
@@ -123,16 +208,19 @@ std::string Maze::str_debug(const std::deque<Direction> &solution, const Positio
     constexpr char head_v[] = "ⸯ";
     constexpr char head_h[] = "~";
     std::ostringstream oss;
-    auto maze_copy(m_maze);
+    auto maze_copy(m_layout->cells);
     auto current_pos = pos;
+    if (m_has_food) {
+        maze_copy[index(m_food)] = Cell::Food;
+    }
 
     for (const auto &dir : solution) {
         current_pos = current_pos + dir;
-        maze_copy[current_pos.coord_y][current_pos.coord_x] =
-            (current_pos != m_food) ? Cell::SnakeBody : Cell::Food;
+        maze_copy[index(current_pos)] = (current_pos != m_food) ? Cell::SnakeBody : Cell::Food;
     }
-    for (const auto &row : maze_copy) {
-        for (const auto &cell : row) {
+    for (size_t row = 0; row < height(); ++row) {
+        for (size_t col = 0; col < width(); ++col) {
+            auto cell = maze_copy[row * width() + col];
             if (cell == Cell::Free or cell == Cell::InvisibleWall or cell == Cell::Spawn) {
                 oss << free;
             } else if (cell == Cell::Wall) {
@@ -149,36 +237,51 @@ std::string Maze::str_debug(const std::deque<Direction> &solution, const Positio
     return oss.str();
 }
 
-std::string Maze::str_in_game(const std::deque<Position> &snake_body,
-                              const Direction &snake_head_direction) const {
+void Maze::paint_in_game(const std::deque<Position> &snake_body,
+                         std::vector<Cell> &canvas) const {
+    canvas.assign(m_layout->cells.cbegin(), m_layout->cells.cend());
+    if (m_has_food) {
+        canvas[index(m_food)] = Cell::Food;
+    }
+    for (const auto &part : snake_body) {
+        canvas[index(part)] = Cell::SnakeBody;
+    }
+    canvas[index(snake_body.front())] = Cell::SnakeHead;
+}
+
+std::string Maze::str_cell_in_game(const Cell &cell, const Direction &snake_head_direction) {
     constexpr char wall_or_body[] = "█";
-    constexpr char free = ' ';
+    constexpr char free[] = " ";
     constexpr char food[] = "◉";
     constexpr char head_v[] = "ⸯ";
     constexpr char head_h[] = "~";
-    std::ostringstream oss;
-    auto maze_copy(m_maze);
-    for (const auto &part : snake_body) {
-        maze_copy[part.coord_y][part.coord_x] = Cell::SnakeBody;
+    if (cell == Cell::Wall) {
+        return Color::tcolor(wall_or_body, Color::GREEN);
     }
-    maze_copy[snake_body.front().coord_y][snake_body.front().coord_x] = Cell::SnakeHead;
-    for (const auto &row : maze_copy) {
-        for (const auto &cell : row) {
-            if (cell == Cell::Free or cell == Cell::InvisibleWall or cell == Cell::Spawn) {
-                oss << free;
-            } else if (cell == Cell::Wall) {
-                oss << Color::tcolor(wall_or_body, Color::GREEN);
-            } else if (cell == Cell::Food) {
-                oss << Color::tcolor(food, Color::MAGENTA);
-            } else if (cell == Cell::SnakeHead) {
-                const auto *head_ch = (snake_head_direction == Direction::Up or
-                                       snake_head_direction == Direction::Down)
-                                          ? head_v
-                                          : head_h;
-                oss << Color::tcolor(head_ch, Color::RED);
-            } else if (cell == Cell::SnakeBody) {
-                oss << Color::tcolor(wall_or_body, Color::YELLOW);
-            }
+    if (cell == Cell::Food) {
+        return Color::tcolor(food, Color::MAGENTA);
+    }
+    if (cell == Cell::SnakeHead) {
+        const auto *head_ch = (snake_head_direction == Direction::Up or
+                               snake_head_direction == Direction::Down)
+                                  ? head_v
+                                  : head_h;
+        return Color::tcolor(head_ch, Color::RED);
+    }
+    if (cell == Cell::SnakeBody) {
+        return Color::tcolor(wall_or_body, Color::YELLOW);
+    }
+    return free;
+}
+
+std::string Maze::str_in_game(const std::deque<Position> &snake_body,
+                              const Direction &snake_head_direction) const {
+    std::ostringstream oss;
+    std::vector<Cell> canvas;
+    paint_in_game(snake_body, canvas);
+    for (size_t row = 0; row < height(); ++row) {
+        for (size_t col = 0; col < width(); ++col) {
+            oss << str_cell_in_game(canvas[row * width() + col], snake_head_direction);
         }
         oss << '\n';
     }
@@ -186,9 +289,14 @@ std::string Maze::str_in_game(const std::deque<Position> &snake_body,
     return oss.str();
 }
 
-void Maze::random_food_position() {
-    m_maze[m_food.coord_y][m_food.coord_x] = Cell::Free;
-    m_food = m_free_cells[std::experimental::randint(0, (int)(m_free_cells.size() - 1))];
-    m_maze[m_food.coord_y][m_food.coord_x] = Cell::Food;
+void Maze::random_food_position(const FreeCellSet &open, Rng &rng) {
+    m_has_food = true;
+    if (not open.empty()) {
+        auto cell = open.at(rng.below(open.size()));
+        m_food = Position(cell % width(), cell / width());
+    } else {
+        const auto &free_cells = m_layout->free_cells;
+        m_food = free_cells[rng.below(free_cells.size())];
+    }
 }
 } // namespace snaze
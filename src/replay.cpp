@@ -0,0 +1,86 @@
+#include "replay.hpp"
+
+#include <cstring>
+#include <ios>
+#include <stdexcept>
+
+namespace snaze {
+ReplayWriter::ReplayWriter(const std::string &filename, const std::string &level,
+                           ReplayHeader header)
+    : m_file(filename, std::ios::binary | std::ios::trunc), m_header(header) {
+    if (not m_file.is_open()) {
+        throw std::runtime_error("Couldn't create file: " + filename);
+    }
+    m_header.ticks = 0;
+    m_header.moves = 0;
+    m_header.food_eaten = 0;
+    m_header.lives_lost = 0;
+    m_header.outcome = REPLAY_UNFINISHED;
+    m_header.level_size = static_cast<uint32_t>(level.size());
+    m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+    m_file.write(level.data(), static_cast<std::streamsize>(level.size()));
+    m_block.reserve(BLOCK_BYTES);
+}
+
+ReplayWriter::~ReplayWriter() {
+    if (not m_finished) {
+        finish(REPLAY_UNFINISHED, m_header.food_eaten, m_header.lives_lost);
+    }
+}
+
+void ReplayWriter::push(const Direction &dir) {
+    auto shift = 2 * (m_header.moves % 4);
+    if (shift == 0) {
+        if (m_block.size() == BLOCK_BYTES) {
+            m_file.write(reinterpret_cast<const char *>(m_block.data()), BLOCK_BYTES);
+            m_block.clear();
+        }
+        m_block.push_back(0);
+    }
+    m_block.back() |= static_cast<uint8_t>(move_code(dir) << shift);
+    ++m_header.moves;
+}
+
+void ReplayWriter::finish(uint8_t outcome, size_t food_eaten, size_t lives_lost) {
+    m_finished = true;
+    m_header.outcome = outcome;
+    m_header.food_eaten = static_cast<uint32_t>(food_eaten);
+    m_header.lives_lost = static_cast<uint32_t>(lives_lost);
+    m_file.write(reinterpret_cast<const char *>(m_block.data()),
+                 static_cast<std::streamsize>(m_block.size()));
+    m_block.clear();
+    m_file.seekp(0);
+    m_file.write(reinterpret_cast<const char *>(&m_header), sizeof(m_header));
+    m_file.close();
+}
+
+ReplayReader::ReplayReader(const std::string &filename) : m_file(filename) {
+    if (m_file.size() < sizeof(m_header)) {
+        throw std::invalid_argument("Not a replay file: " + filename);
+    }
+    std::memcpy(&m_header, m_file.data(), sizeof(m_header));
+    if (m_header.magic != REPLAY_MAGIC or m_header.version != REPLAY_VERSION) {
+        throw std::invalid_argument("Not a replay file: " + filename);
+    }
+    // Checked against the file size first, so no byte count is computed from a corrupted header
+    if (m_header.level_size > m_file.size() - sizeof(m_header)) {
+        throw std::invalid_argument("Corrupted replay file: " + filename);
+    }
+    const auto move_bytes = m_file.size() - sizeof(m_header) - m_header.level_size;
+    if (m_header.moves > move_bytes * 4 or (m_header.moves + 3) / 4 != move_bytes) {
+        throw std::invalid_argument("Corrupted replay file: " + filename);
+    }
+    const auto *level = reinterpret_cast<const char *>(m_file.data() + sizeof(m_header));
+    m_level.assign(level, m_header.level_size);
+    m_moves = m_file.data() + sizeof(m_header) + m_header.level_size;
+}
+
+std::optional<Direction> ReplayReader::next() {
+    if (m_read == m_header.moves) {
+        return std::nullopt;
+    }
+    auto code = (m_moves[m_read / 4] >> (2 * (m_read % 4))) & 3U;
+    ++m_read;
+    return code_move(code);
+}
+} // namespace snaze
@@ -0,0 +1,305 @@
+#include "simulation.hpp"
+#include "game_manager.hpp"
+#include "level_pack.hpp"
+#include "maze.hpp"
+#include "snake.hpp"
+
+#include <chrono>
+#include <exception>
+#include <filesystem>
+#include <iostream>
+#include <optional>
+#include <ostream>
+#include <string>
+#include <utility>
+
+namespace snaze {
+TickOutcome advance_snake(const Maze &maze, Snake &snake) {
+    auto next_head = maze.step(snake.body().front(), snake.head_direction);
+    snake.push_front(next_head);
+    if (maze.blocked(next_head, Direction::None) or snake.is_snake_body(next_head)) {
+        snake.pop_back();
+        return TickOutcome::Crashed;
+    }
+    if (maze.found_food(next_head)) {
+        return TickOutcome::Ate;
+    }
+    snake.pop_back();
+    return TickOutcome::Moved;
+}
+
+Simulation::Simulation(std::string level_file, const Settings &settings, BotMode bot_mode,
+                       size_t max_ticks, uint64_t seed)
+    : m_level_file(std::move(level_file)), m_settings(settings), m_bot_mode(bot_mode),
+      m_max_ticks(max_ticks), m_maze(m_level_file, m_settings.distance_budget_kb << 10),
+      m_snake_bot(bot_mode), m_seed(seed), m_rng(seed), m_bot_rng(~seed) {}
+
+Simulation::Simulation(std::string level_file, const Maze &level, const Settings &settings,
+                       BotMode bot_mode, size_t max_ticks, uint64_t seed)
+    : m_level_file(std::move(level_file)), m_settings(settings), m_bot_mode(bot_mode),
+      m_max_ticks(max_ticks), m_maze(level), m_snake_bot(bot_mode), m_seed(seed), m_rng(seed),
+      m_bot_rng(~seed) {}
+
+void Simulation::record(const std::string &replay_file) {
+    ReplayHeader header;
+    header.seed = m_seed;
+    header.lives = static_cast<uint32_t>(m_settings.lives);
+    header.food_amount = static_cast<uint32_t>(m_settings.food_amount);
+    header.bot_mode = static_cast<uint8_t>(m_bot_mode);
+    m_recorder.emplace(replay_file, m_level_file, header);
+}
+
+void Simulation::game_start() {
+    m_snake.reset(m_maze);
+    if (m_bot_mode == BotMode::Undefined) {
+        // A player picks the start direction of each life, the replay has it before the moves
+        auto start = (m_replay != nullptr) ? m_replay->next() : std::nullopt;
+        m_snake.head_direction = start.value_or(Direction::None);
+        m_snake.push_back(m_maze.start() + m_snake.head_direction);
+        m_maze.random_food_position(m_snake.open_cells(), m_rng);
+        if (m_recorder.has_value() and start.has_value()) {
+            m_recorder->push(start.value());
+        }
+        return;
+    }
+    m_snake_bot.forget();
+    m_snake.push_front(m_maze.start());
+    m_maze.random_food_position(m_snake.open_cells(), m_rng);
+    think();
+}
+
+void Simulation::think() {
+    auto start_time = std::chrono::steady_clock::now();
+    m_snake_bot.think(m_maze, m_snake, m_bot_rng);
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    if (elapsed.count() > m_slowest_think_ms) {
+        m_slowest_think_ms = elapsed.count();
+        m_slowest_think_tick = m_ticks;
+    }
+    ++m_searches;
+    m_nodes_expanded += m_snake_bot.nodes_expanded();
+}
+
+std::optional<Direction> Simulation::next_move() {
+    std::optional<Direction> planned;
+    if (m_bot_mode != BotMode::Undefined) {
+        if (m_snake_bot.solution.value().empty()) {
+            think();
+        }
+        planned = m_snake_bot.solution.value().front();
+        m_snake_bot.solution.value().pop_front();
+    }
+    if (m_replay == nullptr) {
+        return planned;
+    }
+    auto recorded = m_replay->next();
+    if (recorded.has_value() and planned.has_value() and recorded != planned) {
+        if (not m_divergence.has_value()) {
+            m_divergence = m_ticks;
+        }
+        m_snake_bot.solution.value().clear(); // The plan was for a move that wasn't made
+    }
+    return recorded;
+}
+
+GameResult Simulation::run() {
+    auto start_time = std::chrono::steady_clock::now();
+    while (step()) {
+    }
+    std::chrono::duration<double, std::milli> elapsed =
+        std::chrono::steady_clock::now() - start_time;
+    GameResult result;
+    result.level = m_level_file;
+    result.bot_mode = m_bot_mode;
+    result.seed = m_seed;
+    result.outcome = m_outcome.value_or(GameOutcome::Stalled);
+    result.food_eaten = m_food_eaten;
+    result.lives_lost = m_lives_lost;
+    result.ticks = m_ticks;
+    result.wall_ms = elapsed.count();
+    result.searches = m_searches;
+    result.nodes_expanded = m_nodes_expanded;
+    result.slowest_think_ms = m_slowest_think_ms;
+    result.slowest_think_tick = m_slowest_think_tick;
+    if (m_recorder.has_value()) {
+        m_recorder->finish(static_cast<uint8_t>(result.outcome), result.food_eaten,
+                           result.lives_lost);
+    }
+    return result;
+}
+
+bool Simulation::step() {
+    if (not m_started) {
+        m_started = true;
+        game_start();
+    }
+    if (m_outcome.has_value() or m_ticks >= m_max_ticks) {
+        return false;
+    }
+    auto direction = next_move();
+    if (not direction.has_value()) {
+        m_outcome = GameOutcome::Stalled; // The followed replay is over
+        return false;
+    }
+    m_snake.head_direction = direction.value();
+    if (m_recorder.has_value()) {
+        m_recorder->tick(direction.value());
+    }
+    ++m_ticks;
+    auto tick_outcome = advance_snake(m_maze, m_snake);
+    if (tick_outcome == TickOutcome::Crashed) {
+        if (++m_lives_lost == m_settings.lives) {
+            m_outcome = GameOutcome::Lost;
+            return false;
+        }
+        game_start();
+    } else if (tick_outcome == TickOutcome::Ate) {
+        if (++m_food_eaten == m_settings.food_amount) {
+            m_outcome = GameOutcome::Won;
+            return false;
+        }
+        m_maze.random_food_position(m_snake.open_cells(), m_rng);
+    }
+    return true;
+}
+
+GameSnapshot Simulation::snapshot() const {
+    GameSnapshot snapshot;
+    if (m_maze.has_food()) {
+        snapshot.food = m_maze.food();
+    }
+    snapshot.body = m_snake.body();
+    snapshot.head_direction = m_snake.head_direction;
+    if (m_snake_bot.solution.has_value()) {
+        snapshot.plan = m_snake_bot.solution.value();
+    }
+    snapshot.ticks = m_ticks;
+    snapshot.food_eaten = m_food_eaten;
+    snapshot.lives_lost = m_lives_lost;
+    snapshot.rng = m_rng;
+    snapshot.bot_rng = m_bot_rng;
+    return snapshot;
+}
+
+void Simulation::restore(const GameSnapshot &snapshot) {
+    if (not m_started) {
+        m_snake.reset(m_maze); // Fits the occupancy grid, the body comes from the snapshot
+    }
+    m_started = not snapshot.body.empty();
+    if (snapshot.food.has_value()) {
+        m_maze.place_food(snapshot.food.value());
+    } else {
+        m_maze.remove_food();
+    }
+    m_snake.restore(snapshot.body, snapshot.head_direction);
+    m_snake_bot.forget(); // Its kept search was run over another body
+    m_snake_bot.solution = snapshot.plan;
+    m_ticks = snapshot.ticks;
+    m_food_eaten = snapshot.food_eaten;
+    m_lives_lost = snapshot.lives_lost;
+    m_outcome.reset();
+    if (m_food_eaten == m_settings.food_amount) {
+        m_outcome = GameOutcome::Won;
+    } else if (m_lives_lost == m_settings.lives) {
+        m_outcome = GameOutcome::Lost;
+    }
+    m_rng = snapshot.rng;
+    m_bot_rng = snapshot.bot_rng;
+}
+
+std::string to_string(GameOutcome outcome) {
+    switch (outcome) {
+    case GameOutcome::Won:
+        return "won";
+    case GameOutcome::Lost:
+        return "lost";
+    case GameOutcome::Stalled:
+    default:
+        return "stalled";
+    }
+}
+
+std::string to_string(BotMode bot_mode) {
+    switch (bot_mode) {
+    case BotMode::Smart:
+        return "smart";
+    case BotMode::Dumb:
+        return "dumb";
+    case BotMode::Undefined:
+    default:
+        return "undefined";
+    }
+}
+
+void run_headless(const HeadlessOptions &options, std::ostream &os) {
+    os << "level,bot,outcome,food_eaten,lives_lost,ticks,wall_ms,searches,nodes_expanded,seed\n";
+    LevelLoader loader;
+    uint64_t game_number = 0;
+    // Skipped levels keep their game numbers, so a game is numbered by its level as in `run_batch`
+    const auto level_games = options.bot_modes.size() * options.games_per_level;
+    for (const auto &level_file : options.level_files) {
+        std::optional<Maze> loaded;
+        try {
+            loaded.emplace(loader.load(level_file, options.settings.distance_budget_kb << 10));
+        } catch (const std::exception &error) {
+            std::cerr << "Skipping unreadable level " << level_file << ": " << error.what() << '\n';
+            game_number += level_games;
+            continue;
+        }
+        auto &level = loaded.value();
+        if (not level.issues().playable()) {
+            std::cerr << "Skipping unplayable level " << level_file << '\n';
+            game_number += level_games;
+            continue;
+        }
+        for (const auto &bot_mode : options.bot_modes) {
+            for (size_t game = 0; game < options.games_per_level; ++game) {
+                Simulation simulation(level_file, level, options.settings, bot_mode,
+                                      options.max_ticks, options.settings.seed + game_number);
+                if (not options.replay_dir.empty()) {
+                    simulation.record(replay_file(options.replay_dir, game_number));
+                }
+                ++game_number;
+                auto result = simulation.run();
+                os << result.level << ',' << to_string(result.bot_mode) << ','
+                   << to_string(result.outcome) << ',' << result.food_eaten << ','
+                   << result.lives_lost << ',' << result.ticks << ',' << result.wall_ms << ','
+                   << result.searches << ',' << result.nodes_expanded << ',' << result.seed
+                   << '\n';
+            }
+        }
+    }
+    os.flush();
+}
+
+std::string replay_file(const std::string &replay_dir, size_t game_number) {
+    return (std::filesystem::path(replay_dir) /
+            ("game_" + std::to_string(game_number) + REPLAY_EXTENSION))
+        .string();
+}
+
+ReplayCheck verify_replay(const std::string &replay_file, Settings settings) {
+    ReplayReader replay(replay_file);
+    const auto &header = replay.header();
+    settings.lives = header.lives;
+    settings.food_amount = header.food_amount;
+    ReplayCheck check;
+    auto &recorded = check.recorded;
+    recorded.level = replay.level();
+    recorded.bot_mode = static_cast<BotMode>(header.bot_mode);
+    recorded.outcome = (header.outcome == REPLAY_UNFINISHED)
+                           ? GameOutcome::Stalled
+                           : static_cast<GameOutcome>(header.outcome);
+    recorded.food_eaten = header.food_eaten;
+    recorded.lives_lost = header.lives_lost;
+    recorded.ticks = header.ticks;
+    recorded.seed = header.seed;
+
+    Simulation simulation(replay.level(), settings, recorded.bot_mode, header.ticks, header.seed);
+    simulation.follow(replay);
+    check.replayed = simulation.run();
+    check.divergence = simulation.divergence();
+    return check;
+}
+} // namespace snaze
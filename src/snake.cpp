@@ -2,51 +2,53 @@
 #include "maze.hpp"
 
 #include <deque>
-#include <experimental/random>
 #include <optional>
+#include <stdexcept>
 #include <utility>
 namespace snaze {
-SnakeBot::MaybeDirectionDeque SnakeBot::solve(const Maze &maze, const Snake &snake) {
-    std::queue<std::pair<Position, Snake>> to_visit;
-    std::unordered_set<Position, Position::Hash> meta_visited;
-    std::map<Position, Direction> came_from;
-    constexpr std::array directions{Direction::Up, Direction::Down, Direction::Left,
-                                    Direction::Right};
-    auto start_pos = snake.body.front();
-    to_visit.push({start_pos, snake});
-    meta_visited.insert(start_pos);
-    while (not to_visit.empty()) {
-        auto [current_pos, current_snake] = to_visit.front();
-        to_visit.pop();
-        if (maze.found_food(current_pos)) {
-            return reconstruct_path(came_from, start_pos, current_pos);
-        }
-        for (const auto &dir : directions) {
-            if (dir == opposite(current_snake.head_direction)) {
-                continue;
-            }
-            Snake next_snake = current_snake;
-            next_snake.move_snake(dir);
-            auto next_pos = next_snake.body.front();
-            if (next_snake.is_snake_body(next_pos)) {
-                continue;
-            }
-            if (maze.in_bound(next_pos) and not(maze.blocked(next_pos, Direction::None)) and
-                not already_visited(next_pos, meta_visited)) {
-                came_from[next_pos] = dir;
-                to_visit.push({next_pos, next_snake});
-                meta_visited.insert(next_pos);
-            }
+bool SnakeBot::solve(const Maze &maze, const Snake &snake, const SearchLimit &limit) {
+    bool found =
+        (m_mode == BotMode::Smart)
+            ? m_search.a_star(maze, snake.body(), snake.head_direction, m_path, limit)
+            : m_search.breadth_first(maze, snake.body(), snake.head_direction, m_path, limit);
+    m_expanded = m_search.expanded();
+    m_partial = m_search.interrupted();
+    // An empty path means the food lies under the head, that's not a move to make. A
+    // interrupted search leaves in it the path to where it got closest to the food.
+    if ((not found and not m_partial) or m_path.empty()) {
+        return false;
+    }
+    plan(m_path);
+    return true;
+}
+
+std::optional<Direction> SnakeBot::survive(const Maze &maze, const Snake &snake) {
+    m_expanded = 0;
+    std::optional<Direction> best_move;
+    GridSearch::Room best_room;
+    for (const auto &dir : positions_available(maze, snake)) {
+        m_moved = snake.body();
+        m_moved.push_front(maze.step(snake.body().front(), dir));
+        m_moved.pop_back();
+        auto room = m_fill.flood_fill(maze, m_moved);
+        m_expanded += m_fill.expanded();
+        if (not best_move.has_value() or room.tail > best_room.tail or
+            (room.tail == best_room.tail and room.cells > best_room.cells)) {
+            best_move = dir;
+            best_room = room;
+            std::swap(m_fill, m_kept);
+            std::swap(m_moved, m_kept_body);
         }
     }
-    return std::nullopt;
+    m_kept_maze = best_move.has_value() ? &maze : nullptr;
+    return best_move;
 }
 
 std::vector<Direction> SnakeBot::positions_available(const Maze &maze, const Snake &snake) {
     std::vector<Direction> moves;
     for (const auto &dir : {Direction::Up, Direction::Down, Direction::Right, Direction::Left}) {
-        if ((maze.blocked(snake.body.front(), dir) or
-             snake.is_snake_body(snake.body.front() + dir))) {
+        auto next = maze.step(snake.body().front(), dir);
+        if (maze.is_wall(next) or snake.is_snake_body(next)) {
             continue;
         }
         moves.push_back(dir);
@@ -54,14 +56,76 @@ std::vector<Direction> SnakeBot::positions_available(const Maze &maze, const Sna
     return moves;
 }
 
-SnakeBot::MaybeDirectionDeque SnakeBot::play_random(const Maze &maze, const Snake &snake) {
+SnakeBot::MaybeDirectionDeque SnakeBot::play_random(const Maze &maze, const Snake &snake,
+                                                     Rng &rng) {
     MaybeDirectionDeque moves;
     auto available_moves = positions_available(maze, snake);
     if (available_moves.empty()) {
         return std::deque({snake.head_direction});
     }
-    auto head_dir = available_moves[std::experimental::randint(0, (int)available_moves.size() - 1)];
+    auto head_dir = available_moves[rng.below(available_moves.size())];
 
     return std::deque({head_dir});
 }
+
+Direction SnakeBot::fallback_move(const Maze &maze, const Snake &snake) {
+    auto available_moves = positions_available(maze, snake);
+    for (const auto &dir : available_moves) {
+        if (dir == snake.head_direction) {
+            return dir;
+        }
+    }
+    if (not available_moves.empty()) {
+        return available_moves.front();
+    }
+    return snake.head_direction != Direction::None ? snake.head_direction : Direction::Up;
+}
+
+void SnakeBot::think(const Maze &maze, const Snake &snake, Rng &rng,
+                     const SearchLimit &limit) {
+    if (m_kept_maze == &maze and snake.body() == m_kept_body) {
+        // The snake did the move picked by `survive`, its flood fill holds the path, if any
+        m_kept_maze = nullptr;
+        m_expanded = 0;
+        m_partial = false;
+        if (m_kept.path_to(maze, maze.food(), m_path) and not m_path.empty()) {
+            plan(m_path);
+            return;
+        }
+    } else if (solve(maze, snake, limit)) {
+        return;
+    }
+    if (m_partial) {
+        // Out of time with nowhere to go, the flood fills of `survive` aren't bounded
+        plan(fallback_move(maze, snake));
+        return;
+    }
+    auto expanded = m_expanded;
+    auto move = survive(maze, snake);
+    m_expanded += expanded;
+    if (move.has_value()) {
+        plan(move.value());
+        return;
+    }
+    // Every move crashes, so whichever
+    auto random_move = play_random(maze, snake, rng);
+    if (not random_move.has_value() or random_move.value().empty()) {
+        throw std::runtime_error("Something went wrong, while the bot was thinking");
+    }
+    plan(random_move.value().front());
+}
+
+void SnakeBot::plan(const std::vector<Direction> &moves) {
+    if (not solution.has_value()) {
+        solution.emplace();
+    }
+    solution.value().assign(moves.cbegin(), moves.cend());
+}
+
+void SnakeBot::plan(Direction move) {
+    if (not solution.has_value()) {
+        solution.emplace();
+    }
+    solution.value().assign(1, move);
+}
 } // namespace snaze
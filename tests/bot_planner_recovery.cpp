@@ -0,0 +1,80 @@
+// Checks that the bot planner takes plans again after one wasn't ready in time: the snake makes
+// fallback moves for a tick or two and then follows plans as before.
+#include <chrono>
+#include <cstdlib>
+#include <deque>
+#include <iostream>
+#include <string>
+#include <utility>
+
+#include "bot_planner.hpp"
+#include "maze.hpp"
+#include "rng.hpp"
+#include "simulation.hpp"
+#include "snake.hpp"
+
+using namespace snaze;
+
+int main(int argc, char *argv[]) {
+    const std::string level_file = (argc > 1) ? argv[1] : "assets/level6.dat";
+    constexpr size_t TICKS = 200;         // Ticks played, if the snake doesn't crash first
+    constexpr size_t RECOVERY_TAKES = 3;  // Takes after the miss by which a plan must be taken
+    const std::chrono::duration<double, std::milli> missed_budget(1e-6);
+    const std::chrono::duration<double, std::milli> budget(1000);
+
+    Maze maze(level_file);
+    Snake snake;
+    snake.reset(maze);
+    snake.push_front(maze.start());
+    Rng rng(1);
+    Rng bot_rng(2);
+    maze.random_food_position(snake.open_cells(), rng);
+    BotPlanner planner;
+    planner.reset(maze, BotMode::Smart);
+    std::deque<Direction> moves;
+    planner.request(maze, snake, moves, rng, bot_rng);
+
+    // Played as `SnazeManager::next_bot_move`, the first plan being given no time at all
+    size_t takes = 0;
+    size_t fallbacks = 0;
+    size_t first_plan = 0;
+    for (size_t tick = 0; tick < TICKS; ++tick) {
+        if (moves.empty()) {
+            auto plan =
+                planner.take(maze, snake, rng, bot_rng, (takes == 0) ? missed_budget : budget);
+            if (plan.fallback) {
+                ++fallbacks;
+            } else if (first_plan == 0) {
+                first_plan = takes;
+            }
+            if (takes == 0 and not plan.fallback) {
+                std::cerr << "The first plan was ready in no time, there's no miss\n";
+                return EXIT_FAILURE;
+            }
+            ++takes;
+            moves = std::move(plan.moves);
+            bot_rng = plan.bot_rng;
+            planner.request(maze, snake, moves, rng, bot_rng);
+        }
+        snake.head_direction = moves.front();
+        moves.pop_front();
+        auto tick_outcome = advance_snake(maze, snake);
+        if (tick_outcome == TickOutcome::Crashed) {
+            break;
+        }
+        if (tick_outcome == TickOutcome::Ate) {
+            maze.random_food_position(snake.open_cells(), rng);
+        }
+    }
+    std::cout << level_file << ": " << takes << " takes, " << fallbacks << " fallbacks, first plan"
+              << " taken on take " << first_plan << '\n';
+    if (first_plan == 0 or first_plan > RECOVERY_TAKES) {
+        std::cerr << "No plan was taken within " << RECOVERY_TAKES << " takes of the miss\n";
+        return EXIT_FAILURE;
+    }
+    if (fallbacks != first_plan) {
+        std::cerr << "The planner fell behind again once recovered\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}